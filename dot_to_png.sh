@@ -6,6 +6,12 @@ GRAPHFILE=$GRAPHFOLDER/graph.gv
 SIMTIME=864000
 SIMSRVNODES=(10 20 30 40 50 100 150 200)
 SIMCLTNODES=(10 20 30 40 50 100 150 200 250 500 1000)
+# lay the graphs out in bittopsim instead, graphviz only draws them
+#LAYOUTITERATIONS=300
+if [ -n "$LAYOUTITERATIONS" ]; then
+	SIMCMD="$SIMCMD --layout $LAYOUTITERATIONS"
+	DOTCMDS=("neato -n")
+fi
 
 #cleanup before start:
 rm $GRAPHFOLDER/*
@@ -14,10 +20,10 @@ for i in ${SIMSRVNODES[*]}; do
 		echo "Running for $i server nodes and $j client nodes:"
 		mkdir -p $GRAPHFOLDER
 		$SIMCMD $i $j $SIMTIME 3 $GRAPHFILE > /dev/null
-		for k in ${DOTCMDS[*]}; do
+		for k in "${DOTCMDS[@]}"; do
 			echo "\tRunning $k:"
-			$k -Tpng -Gsize=9,15\! -Gdpi=100 $GRAPHFILE -o $GRAPHFOLDER/$i-$j-$k.png
-			$k -Tpng -Gsize=9,15\! -Gdpi=100 $GRAPHFILE.random.gv -o $GRAPHFOLDER/$i-$j-$k.random.png
+			$k -Tpng -Gsize=9,15\! -Gdpi=100 $GRAPHFILE -o "$GRAPHFOLDER/$i-$j-${k// /}.png"
+			$k -Tpng -Gsize=9,15\! -Gdpi=100 $GRAPHFILE.random.gv -o "$GRAPHFOLDER/$i-$j-${k// /}.random.png"
 		done
 	done
 done
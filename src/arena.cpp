@@ -0,0 +1,42 @@
+#include "arena.h"
+#include <algorithm>
+#include <cstdint>
+
+ScratchArena::ScratchArena(size_t blockSize) : blockSize(blockSize), current(0), offset(0) {}
+
+void* ScratchArena::allocate(size_t bytes, size_t alignment)
+{
+	// the first block with room for the allocation, the ones in between stay unused until the reset
+	for(; current < blocks.size(); ++current, offset = 0) {
+		uintptr_t base = reinterpret_cast<uintptr_t>(blocks[current].memory.get());
+		size_t start = ((base + offset + alignment - 1) & ~(uintptr_t) (alignment - 1)) - base;
+		if(start + bytes <= blocks[current].size) {
+			offset = start + bytes;
+			return blocks[current].memory.get() + start;
+		}
+	}
+
+	// new blocks come from new[], which is aligned for every fundamental type
+	Block block;
+	block.size = std::max(blockSize, bytes);
+	block.memory.reset(new char[block.size]);
+	blocks.push_back(std::move(block));
+	current = blocks.size() - 1;
+	offset = bytes;
+	return blocks[current].memory.get();
+}
+
+void ScratchArena::reset()
+{
+	current = 0;
+	offset = 0;
+}
+
+size_t ScratchArena::getCapacity() const
+{
+	size_t capacity = 0;
+	for(const Block& block : blocks) {
+		capacity += block.size;
+	}
+	return capacity;
+}
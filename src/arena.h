@@ -0,0 +1,92 @@
+/*!
+ * \brief The scratch memory of the temporaries of a tick
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+/*!
+ * \brief A bump allocator whose memory is handed back all at once at the end of a tick.
+ *
+ * Allocations only move a pointer forward in a block, deallocations do nothing. reset()
+ * makes all blocks available again without freeing them, so after the first ticks the
+ * temporaries don't reach malloc anymore.
+ */
+class ScratchArena
+{
+public:
+	typedef std::shared_ptr<ScratchArena> ptr; //!< a shared_ptr of type ScratchArena.
+
+	/*!
+	 * \param blockSize is the size of a block in bytes, larger allocations get a block of their own.
+	 */
+	ScratchArena(size_t blockSize);
+
+	/*!
+	 * \brief returns uninitialized memory, valid until the next reset()
+	 * \param bytes is the size of the memory.
+	 * \param alignment is the alignment of the memory, a power of two.
+	 */
+	void* allocate(size_t bytes, size_t alignment);
+
+	/*!
+	 * \brief releases all allocations, the blocks are kept for reuse
+	 * \constraint nothing allocated from the arena may be used afterwards
+	 */
+	void reset();
+
+	size_t getCapacity() const; //!< returns the bytes of all blocks
+
+private:
+	/*!
+	 * \brief a chunk of memory the allocations are carved from
+	 */
+	typedef struct Block {
+		std::unique_ptr<char[]> memory; //!< the memory of the block
+		size_t size; //!< the size of the block in bytes
+	} Block;
+
+	std::vector<Block> blocks; //!< all blocks, the ones before current are full
+	size_t blockSize; //!< the size of a regular block
+	size_t current; //!< the block allocations are carved from
+	size_t offset; //!< the first free byte of the current block
+};
+
+/*!
+ * \brief A standard allocator on top of a ScratchArena, for containers which don't outlive the tick.
+ */
+template<typename T>
+class ScratchAllocator
+{
+public:
+	typedef T value_type; //!< the type of the allocated objects
+
+	ScratchAllocator(ScratchArena& arena) : arena(&arena) {}
+
+	template<typename U>
+	ScratchAllocator(const ScratchAllocator<U>& other) : arena(other.arena) {}
+
+	T* allocate(size_t n)
+	{
+		return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T)));
+	}
+
+	void deallocate(T*, size_t) {} //!< the memory is released by ScratchArena::reset()
+
+	template<typename U>
+	bool operator==(const ScratchAllocator<U>& other) const { return arena == other.arena; }
+
+	template<typename U>
+	bool operator!=(const ScratchAllocator<U>& other) const { return arena != other.arena; }
+
+private:
+	template<typename U> friend class ScratchAllocator;
+
+	ScratchArena* arena; //!< the arena the memory is taken from
+};
+
+#endif // ARENA_H
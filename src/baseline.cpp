@@ -0,0 +1,205 @@
+#include "baseline.h"
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <unistd.h>
+
+BaselineCache::BaselineCache(std::string directory) : directory(directory) {}
+
+std::string BaselineCache::makeKey(unsigned long vertices, unsigned long edges, std::string generator, unsigned long seed)
+{
+	return "random-" + std::to_string(vertices) + "-" + std::to_string(edges) + "-" + generator + "-" + std::to_string(seed);
+}
+
+std::string BaselineCache::pathOf(std::string key)
+{
+	return directory + "/" + key + ".baseline";
+}
+
+template<typename T>
+static bool readCounts(std::istream& in, std::vector<T>& counts)
+{
+	unsigned long size;
+	if(!(in >> size)) return false;
+	counts.resize(size);
+	for(T& count : counts) {
+		if(!(in >> count)) return false;
+	}
+	return true;
+}
+
+template<typename T>
+static void writeCounts(std::ostream& out, const std::vector<T>& counts)
+{
+	out << " " << counts.size();
+	for(const T& count : counts) {
+		out << " " << count;
+	}
+}
+
+bool BaselineCache::load(std::string key, BaselineResults& results)
+{
+	std::ifstream file(pathOf(key));
+	std::string token;
+	if(!(file >> token) || token != "bittopsim-baseline" || !(file >> token) || token != "1") return false;
+	if(!(file >> token) || token != key) return false;
+
+	BaselineResults cached;
+	while(file >> token) {
+		if(token == "clustering") {
+			if(!(file >> cached.clustering)) return false;
+			cached.hasClustering = true;
+		} else if(token == "diameter") {
+			if(!(file >> cached.diameter >> cached.diameterPasses)) return false;
+			cached.hasDiameter = true;
+		} else if(token == "distances") {
+			uint64_t disconnected;
+			std::vector<uint64_t> pairs;
+			if(!(file >> disconnected) || !readCounts(file, pairs)) return false;
+			for(uint32_t hops = 0; hops < pairs.size(); ++hops) {
+				if(pairs[hops] > 0) cached.distances.add(hops, pairs[hops]);
+			}
+			cached.distances.addDisconnected(disconnected);
+			cached.hasDistances = true;
+		} else if(token == "betweenness") {
+			if(!(file >> cached.metrics.maxBetweenness >> cached.metrics.meanBetweenness)) return false;
+			cached.metricsMask |= BETWEENNESS;
+		} else if(token == "kcore") {
+			if(!(file >> cached.metrics.degeneracy) || !readCounts(file, cached.metrics.coreSizes)) return false;
+			cached.metricsMask |= KCORE;
+		} else if(token == "degree") {
+			if(!(file >> cached.metrics.maxDegree >> cached.metrics.meanDegree) || !readCounts(file, cached.metrics.degrees)) return false;
+			cached.metricsMask |= DEGREE;
+		} else if(token == "assortativity") {
+			if(!(file >> cached.metrics.assortativity)) return false;
+			cached.metricsMask |= ASSORTATIVITY;
+		} else if(token == "components") {
+			if(!(file >> cached.metrics.components >> cached.metrics.largestComponent >> cached.metrics.isolatedVertices)) return false;
+			cached.metricsMask |= COMPONENTS;
+		} else if(token == "resilience") {
+			if(!(file >> cached.resilienceRuns)) return false;
+			for(ResilienceCurve* curve : {&cached.randomRemoval, &cached.degreeRemoval}) {
+				for(unsigned int f = 0; f < REMOVALFRACTIONS; ++f) {
+					if(!(file >> curve->giant[f])) return false;
+				}
+				if(!(file >> curve->robustness)) return false;
+			}
+		} else if(token == "spectrum") {
+			if(!(file >> cached.spectrum.vertices >> cached.spectrum.algebraicConnectivity >> cached.spectrum.spectralGap >> cached.spectrum.iterations >> cached.spectrum.converged)) return false;
+			cached.hasSpectrum = true;
+		} else if(token == "propagation") {
+			if(!(file >> cached.propagationKey >> cached.propagation.sources)) return false;
+			for(unsigned int c = 0; c < PROPAGATIONCOVERAGES; ++c) {
+				if(!(file >> cached.propagation.meanTime[c] >> cached.propagation.maxTime[c] >> cached.propagation.unreached[c])) return false;
+			}
+		} else {
+			return false;
+		}
+	}
+
+	results = cached;
+	return true;
+}
+
+bool BaselineCache::store(std::string key, BaselineResults& results)
+{
+	//! \constraint runs of a sweep may share an entry, so it is replaced atomically with a rename
+	std::string path = pathOf(key);
+	std::string tmpPath = path + ".tmp." + std::to_string(getpid());
+	{
+		std::ofstream file(tmpPath);
+		if(!file.is_open()) return false;
+		file.precision(std::numeric_limits<double>::max_digits10);
+
+		file << "bittopsim-baseline 1" << std::endl;
+		file << key << std::endl;
+		if(results.hasClustering) {
+			file << "clustering " << results.clustering << std::endl;
+		}
+		if(results.hasDiameter) {
+			file << "diameter " << results.diameter << " " << results.diameterPasses << std::endl;
+		}
+		if(results.hasDistances) {
+			std::vector<uint64_t> pairs;
+			for(uint32_t hops = 0; hops <= results.distances.getMaxHops(); ++hops) {
+				pairs.push_back(results.distances.getPairs(hops));
+			}
+			file << "distances " << results.distances.getDisconnectedPairs();
+			writeCounts(file, pairs);
+			file << std::endl;
+		}
+		GraphMetrics& metrics = results.metrics;
+		if(results.metricsMask & BETWEENNESS) {
+			file << "betweenness " << metrics.maxBetweenness << " " << metrics.meanBetweenness << std::endl;
+		}
+		if(results.metricsMask & KCORE) {
+			file << "kcore " << metrics.degeneracy;
+			writeCounts(file, metrics.coreSizes);
+			file << std::endl;
+		}
+		if(results.metricsMask & DEGREE) {
+			file << "degree " << metrics.maxDegree << " " << metrics.meanDegree;
+			writeCounts(file, metrics.degrees);
+			file << std::endl;
+		}
+		if(results.metricsMask & ASSORTATIVITY) {
+			file << "assortativity " << metrics.assortativity << std::endl;
+		}
+		if(results.metricsMask & COMPONENTS) {
+			file << "components " << metrics.components << " " << metrics.largestComponent << " " << metrics.isolatedVertices << std::endl;
+		}
+		if(results.resilienceRuns > 0) {
+			file << "resilience " << results.resilienceRuns;
+			for(ResilienceCurve* curve : {&results.randomRemoval, &results.degreeRemoval}) {
+				for(unsigned int f = 0; f < REMOVALFRACTIONS; ++f) {
+					file << " " << curve->giant[f];
+				}
+				file << " " << curve->robustness;
+			}
+			file << std::endl;
+		}
+		if(results.hasSpectrum) {
+			const SpectralStats& spectrum = results.spectrum;
+			file << "spectrum " << spectrum.vertices << " " << spectrum.algebraicConnectivity << " " << spectrum.spectralGap << " " << spectrum.iterations << " " << spectrum.converged << std::endl;
+		}
+		if(!results.propagationKey.empty()) {
+			file << "propagation " << results.propagationKey << " " << results.propagation.sources;
+			for(unsigned int c = 0; c < PROPAGATIONCOVERAGES; ++c) {
+				file << " " << results.propagation.meanTime[c] << " " << results.propagation.maxTime[c] << " " << results.propagation.unreached[c];
+			}
+			file << std::endl;
+		}
+		if(!file.good()) {
+			std::remove(tmpPath.c_str());
+			return false;
+		}
+	}
+	return std::rename(tmpPath.c_str(), path.c_str()) == 0;
+}
+
+void mergeMetrics(GraphMetrics& into, const GraphMetrics& from, unsigned int mask)
+{
+	if(mask & BETWEENNESS) {
+		into.betweenness = from.betweenness;
+		into.maxBetweenness = from.maxBetweenness;
+		into.meanBetweenness = from.meanBetweenness;
+	}
+	if(mask & KCORE) {
+		into.coreness = from.coreness;
+		into.degeneracy = from.degeneracy;
+		into.coreSizes = from.coreSizes;
+	}
+	if(mask & DEGREE) {
+		into.degrees = from.degrees;
+		into.maxDegree = from.maxDegree;
+		into.meanDegree = from.meanDegree;
+	}
+	if(mask & ASSORTATIVITY) {
+		into.assortativity = from.assortativity;
+	}
+	if(mask & COMPONENTS) {
+		into.components = from.components;
+		into.largestComponent = from.largestComponent;
+		into.isolatedVertices = from.isolatedVertices;
+	}
+}
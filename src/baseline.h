@@ -0,0 +1,96 @@
+/*!
+ * \brief A persistent cache of the analysis results of the random baseline graphs
+ */
+
+#ifndef BASELINE_H
+#define BASELINE_H
+
+#include "distance.h"
+#include "metrics.h"
+#include "propagation.h"
+#include "resilience.h"
+#include "spectral.h"
+#include <memory>
+#include <string>
+
+/*!
+ * \brief The analysis results of a graph, those of the random baseline graphs are cached.
+ *
+ * Only the parts which were calculated are filled in, a cached entry grows as runs ask for more.
+ * The per-vertex results of the metrics (betweenness, coreness) aren't kept, only what is printed.
+ */
+typedef struct BaselineResults {
+	bool hasClustering = false; //!< was the clustering coefficient calculated?
+	float clustering = 0; //!< the clustering coefficient
+	bool hasDiameter = false; //!< was the diameter calculated?
+	uint32_t diameter = 0; //!< the exact diameter
+	unsigned long diameterPasses = 0; //!< the traversals the diameter needed
+	bool hasDistances = false; //!< was the hop distance distribution calculated?
+	DistanceHistogram distances; //!< the hop distance distribution
+	unsigned int metricsMask = 0; //!< the structure metrics which were calculated, see Metric
+	GraphMetrics metrics; //!< the structure metrics
+	std::string propagationKey; //!< the settings the propagation was simulated with, empty if it wasn't
+	PropagationStats propagation; //!< the propagation times
+	unsigned long resilienceRuns = 0; //!< the number of random removal orders, 0 if the resilience wasn't calculated
+	ResilienceCurve randomRemoval; //!< the giant component under random removal
+	ResilienceCurve degreeRemoval; //!< the giant component under removal by decreasing degree
+	bool hasSpectrum = false; //!< were the extremal eigenvalues calculated?
+	SpectralStats spectrum; //!< the algebraic connectivity and the spectral gap
+} BaselineResults;
+
+/*!
+ * \brief Stores the results of the random baseline graphs in a directory, one file per graph.
+ *
+ * A random graph is fully determined by its number of vertices and edges, its generator
+ * and the seed of the generator, so these form the key of an entry.
+ */
+class BaselineCache
+{
+public:
+	typedef std::shared_ptr<BaselineCache> ptr; //!< a shared_ptr of type BaselineCache.
+
+	/*!
+	 * \param directory is the directory the entries are stored in, it has to exist.
+	 */
+	BaselineCache(std::string directory);
+
+	/*!
+	 * \brief builds the key of a random graph
+	 * \param vertices is the number of vertices.
+	 * \param edges is the number of edges.
+	 * \param generator names the generator of the graph.
+	 * \param seed is the seed of the generator.
+	 */
+	static std::string makeKey(unsigned long vertices, unsigned long edges, std::string generator, unsigned long seed);
+
+	/*!
+	 * \brief reads the cached results of a random graph
+	 * \param key is the key of the graph.
+	 * \param results will hold the cached results.
+	 * \return false if there is no (readable) entry
+	 */
+	bool load(std::string key, BaselineResults& results);
+
+	/*!
+	 * \brief writes the results of a random graph, replacing an existing entry
+	 * \param key is the key of the graph.
+	 * \param results are the results to store.
+	 * \return false if the entry couldn't be written
+	 */
+	bool store(std::string key, BaselineResults& results);
+
+private:
+	std::string pathOf(std::string key); //!< the file of an entry
+
+	std::string directory; //!< the directory of the entries
+};
+
+/*!
+ * \brief copies the selected metrics from one result into another
+ * \param into is the result to copy to.
+ * \param from is the result to copy from.
+ * \param mask selects the metrics to copy, see Metric.
+ */
+void mergeMetrics(GraphMetrics& into, const GraphMetrics& from, unsigned int mask);
+
+#endif // BASELINE_H
@@ -1,5 +1,14 @@
 #include "bittopsim.h"
 #include <iostream>
+#include <cstdio>
+#include <csignal>
+#include <getopt.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <fstream>
+#include <cmath>
+#include <algorithm>
 #include "constants.h"
 #include <boost/graph/random.hpp> // for the random graph
 #include <boost/random/mersenne_twister.hpp> // for the random number generator
@@ -7,71 +16,389 @@
 
 unsigned long Simulation::simClock; /// the current time for the simulation
 
-Simulation::Simulation(unsigned int numberOfServerNodes, unsigned int numberOfClientNodes, unsigned long simDuration, std::string graphFilePath, int churn)
+Simulation::Simulation(unsigned int numberOfServerNodes, unsigned int numberOfClientNodes, unsigned long simDuration, std::string graphFilePath, int churn, const SimulationOptions& options) : bus(std::make_shared<MessageBus>()), arena(std::make_shared<ScratchArena>(SCRATCHBLOCKSIZE)), options(options), crawlStart(0), crawlOffset(0), branchIndex(NOINDEX), branchAddrMessages(0), connectionEnds(0), lastBootTime(0)
 {
 
 	// time our sim should stop
 	unsigned long endTime = getSimClock() + simDuration;
 
+	// continue from a saved topology, its nodes come first in the population
+	std::vector<std::pair<unsigned long, unsigned long>> restored;
+	if(!options.loadTopologyPath.empty() && !loadTopology(options.loadTopologyPath, restored)) {
+		std::cerr << "Could not load the topology from " << options.loadTopologyPath << "." << std::endl;
+		exit(EXIT_FAILURE);
+	}
+	unsigned long loadedNodes = allNodes.size();
+
 	// generate spawn times:
 	Node::ptr n;
-	unsigned long timeSlot;
 	for (unsigned int i = 0; i < numberOfServerNodes; ++i) {
 		try {
-			n = std::make_shared<Node>(this);
+			n = std::make_shared<ServerNode>(this);
 		} catch(std::bad_alloc& ba) {
 			std::cerr << "Not enough memory: " << ba.what() << std::endl;
 		}
 		LOG("Creating Server Node " << n->getID() << ".");
-		timeSlot = (unsigned long) getSimClock() + rand() % simDuration;
-		bootSchedule[timeSlot].push_back(n);
-		allNodes.push_back(n);
+		addNode(n, (unsigned long) getSimClock() + rand() % simDuration);
 	}
 
 	for (unsigned int i = 0; i < numberOfClientNodes; ++i) {
 		try {
-			n = std::make_shared<Node>(this, false);
+			n = std::make_shared<ClientNode>(this);
 		} catch(std::bad_alloc& ba) {
 			std::cerr << "Not enough memory: " << ba.what() << std::endl;
 		}
 		LOG("Creating Client Node " << n->getID() << ".");
-		timeSlot = (unsigned long) getSimClock() + rand() % simDuration;
-		bootSchedule[timeSlot].push_back(n);
-		allNodes.push_back(n);
+		addNode(n, (unsigned long) getSimClock() + rand() % simDuration);
+	}
+
+	// the nodes of a crawl are only created when they show up
+	if(!options.crawlPath.empty() && !openCrawl(options.crawlPath)) {
+		std::cerr << "Could not read the crawl " << options.crawlPath << "." << std::endl;
+		exit(EXIT_FAILURE);
+	}
+	unsigned long populationSize = allNodes.size() + (crawl != nullptr ? crawl->getNodes() : 0);
+
+	Graph g;
+	if(options.shards > 1) {
+		runShards(endTime, churn, g);
+	} else {
+		seed = std::make_shared<DNSSeeder>(this);
+		if(!options.topologyLogPath.empty()) {
+			topologyLog = std::make_shared<TopologyLog>(options.topologyLogPath, populationSize, options.keyframeInterval);
+			if(!topologyLog->isOpen()) {
+				std::cerr << "Could not open " << options.topologyLogPath << ", not logging the topology." << std::endl;
+				topologyLog = nullptr;
+			}
+		}
+		if(options.liveStatsInterval > 0) {
+			liveStats = std::make_shared<LiveStats>(populationSize);
+		}
+		if(options.coverageAddrs > 0) {
+			addrCoverage = std::make_shared<AddrCoverage>(options.coverageAddrs, options.coverageSince, populationSize);
+
+			// the loaded nodes came online before the coverage was created, they count as knowers but are never watched
+			for(unsigned long i = 0; i < loadedNodes; ++i) {
+				addrCoverage->nodeRestored(i, allNodes[i]->isOnline());
+				for(const Node::ptr& known : allNodes[i]->getKnownNodes()) {
+					addrCoverage->learned(i, known->getIndex());
+				}
+			}
+		}
+		if(!options.statsName.empty()) {
+			openStatsExport(options.statsName, 0);
+		}
+		restoreTopology(restored);
+		if(options.convergenceTolerance > 0) {
+			convergence = std::make_shared<ConvergenceMonitor>(options.convergenceTolerance, options.convergenceWindow);
+			if(lastBootTime + options.convergenceWindow >= endTime) {
+				std::cerr << "The last node joins at tick " << lastBootTime << ", too late for the run to converge before its end." << std::endl;
+			}
+		}
+		run(endTime, churn);
+		if(branchResults != nullptr) {
+			finishBranch();
+			return;
+		}
+		if(addrCoverage != nullptr) {
+			printAddrCoverage();
+		}
+		if(topologyLog != nullptr) {
+			topologyLog->close();
+			topologyLog = nullptr;
+		}
+		if(!options.saveTopologyPath.empty() && !saveTopology(options.saveTopologyPath)) {
+			std::cerr << "Could not save the topology to " << options.saveTopologyPath << "." << std::endl;
+		}
+
+		for(const Node::ptr& n : onlineNodes) {
+			if((n->getConnections()).empty()) {
+				std::cout << n->getID() << " has no connections!!" << std::endl;
+			}
+		}
+	}
+
+	// build the graph, analyse it next to the random graph and write both
+	analyse(g, options.shards <= 1, graphFilePath);
+}
+
+void Simulation::addNode(const Node::ptr& node, unsigned long bootTime)
+{
+	registerNode(node);
+	bootSchedule[bootTime].push_back(node);
+	lastBootTime = std::max(lastBootTime, bootTime);
+}
+
+void Simulation::registerNode(const Node::ptr& node)
+{
+	node->setIndex(allNodes.size());
+	allNodes.push_back(node);
+	onlineSlots.push_back(NOINDEX);
+	offlineSlots.push_back(NOINDEX);
+}
+
+bool Simulation::openCrawl(std::string path)
+{
+	crawl = std::make_shared<CrawlStream>(path);
+	if(!crawl->isOpen()) {
+		crawl = nullptr;
+		return false;
+	}
+	crawlStart = getSimClock();
+	crawlOffset = allNodes.size();
+	crawlSessionEnds.reserve(crawl->getNodes());
+	lastBootTime = std::max(lastBootTime, crawlStart + crawl->getLastSeen() * CRAWLTICKSPERSECOND);
+	return true;
+}
+
+void Simulation::ingestCrawl()
+{
+	const CrawlRecord* record;
+	while((record = crawl->next((getSimClock() - crawlStart) / CRAWLTICKSPERSECOND)) != nullptr) {
+		unsigned long created = allNodes.size() - crawlOffset;
+		if(record->node > created) {
+			std::cerr << "The crawl refers to node " << record->node << " before it showed up, skipping the session." << std::endl;
+			continue;
+		}
+
+		//! \constraint the role of a node is fixed, later sessions keep the reachability it was first seen with
+		Node::ptr node;
+		if(record->node == created) {
+			if(record->flags & CRAWLREACHABLE) {
+				node = std::make_shared<ServerNode>(this);
+			} else {
+				node = std::make_shared<ClientNode>(this);
+			}
+			registerNode(node);
+			crawlSessionEnds.push_back(OPENSESSION);
+		} else {
+			node = allNodes[crawlOffset + record->node];
+		}
+
+		unsigned long& sessionEnd = crawlSessionEnds[record->node];
+		sessionEnd = record->uptime == 0 ? OPENSESSION : getSimClock() + record->uptime * CRAWLTICKSPERSECOND;
+		if(sessionEnd != OPENSESSION) {
+			crawlStops[sessionEnd].push_back(node);
+		}
+		if(!node->isOnline()) {
+			node->start();
+		}
 	}
 
-	seed = std::make_shared<DNSSeeder>(this);
-	
+	auto stops = crawlStops.find(getSimClock());
+	if(stops != std::end(crawlStops)) {
+		//! \constraint a node which started another session meanwhile stays online until that one ends
+		for(const Node::ptr& node : stops->second) {
+			if(node->isOnline() && crawlSessionEnds[node->getIndex() - crawlOffset] == getSimClock()) {
+				node->stop();
+			}
+		}
+		crawlStops.erase(stops);
+	}
+}
+
+bool Simulation::loadTopology(std::string path, std::vector<std::pair<unsigned long, unsigned long>>& restored)
+{
+	std::ifstream file(path);
+	std::string token;
+	unsigned long numberOfNodes, numberOfConnections;
+	if(!(file >> token) || token != "bittopsim-topology" || !(file >> token) || token != "1") return false;
+	if(!(file >> token >> numberOfNodes) || token != "nodes") return false;
+
+	// the indices of the file are kept, so the nodes have to be added in order
+	unsigned long first = allNodes.size();
+	for(unsigned long i = 0; i < numberOfNodes; ++i) {
+		unsigned long index;
+		char role;
+		bool online;
+		if(!(file >> index >> role >> online) || index != i || (role != 'S' && role != 'C')) return false;
+
+		Node::ptr node;
+		if(role == 'S') {
+			node = std::make_shared<ServerNode>(this);
+		} else {
+			node = std::make_shared<ClientNode>(this);
+		}
+		registerNode(node);
+
+		// offline nodes wait for the churn to start them
+		if(online) {
+			node->warmStart();
+		} else {
+			setNodeOffline(node);
+		}
+	}
+
+	if(!(file >> token >> numberOfConnections) || token != "connections") return false;
+	for(unsigned long i = 0; i < numberOfConnections; ++i) {
+		unsigned long origin, dest;
+		if(!(file >> origin >> dest) || origin >= numberOfNodes || dest >= numberOfNodes) return false;
+		restored.push_back(std::make_pair(first + origin, first + dest));
+	}
+
+	// the known addresses are optional, plain edge lists leave them out
+	if(!(file >> token)) return true;
+	unsigned long numberOfLines;
+	if(token != "known" || !(file >> numberOfLines)) return false;
+	Node::vector known;
+	for(unsigned long i = 0; i < numberOfLines; ++i) {
+		unsigned long index, count, k;
+		if(!(file >> index >> count) || index >= numberOfNodes) return false;
+		known.clear();
+		for(unsigned long j = 0; j < count; ++j) {
+			if(!(file >> k) || k >= numberOfNodes) return false;
+			known.push_back(allNodes[first + k]);
+		}
+		allNodes[first + index]->restoreKnownNodes(known);
+	}
+	return true;
+}
+
+void Simulation::restoreTopology(std::vector<std::pair<unsigned long, unsigned long>>& restored)
+{
+	if(options.loadTopologyPath.empty()) return;
+
+	// only the warm started nodes are online yet, the ones without saved known addresses are seeded below
+	Node::vector restoredNodes = onlineNodes;
+	std::vector<bool> needsSeeds(restoredNodes.size());
+	for(unsigned long i = 0; i < restoredNodes.size(); ++i) {
+		needsSeeds[i] = restoredNodes[i]->getKnownNodes().empty();
+	}
+
+	for(auto& connection : restored) {
+		Node::ptr origin = allNodes[connection.first];
+		if(!origin->restoreConnection(allNodes[connection.second])) {
+			LOG("\tCould not restore the connection " << origin->getID() << " --> " << allNodes[connection.second]->getID());
+		}
+	}
+
+	//! \constraint without saved known addresses, a converged node is assumed to know the peers of its peers and the DNS seeds
+	const Node::vector& nodesFromSeeds = seed->queryDNS();
+	for(unsigned long i = 0; i < restoredNodes.size(); ++i) {
+		Node::ptr node = restoredNodes[i];
+		if(!needsSeeds[i]) {
+			node->requestMaintenance();
+			continue;
+		}
+		for(const Node::ptr& peer : node->getConnections()) {
+			const Node::vector& peersOfPeer = peer->getConnections();
+			for(const Node::ptr& n : peersOfPeer) {
+				if(n->isReachable() && *n != *node) {
+					node->addKnownNode(n);
+				}
+			}
+		}
+		node->addKnownNodes(nodesFromSeeds);
+		node->requestMaintenance();
+	}
+}
+
+bool Simulation::saveTopology(std::string path)
+{
+	std::ofstream file(path);
+	if(!file.is_open()) return false;
+
+	file << "bittopsim-topology 1" << std::endl;
+	file << "nodes " << allNodes.size() << std::endl;
+	for(const Node::ptr& node : allNodes) {
+		file << node->getIndex() << " " << (node->getRole() == Node::SERVER ? 'S' : 'C') << " " << node->isOnline() << "\n";
+	}
+
+	// only the outbound side of every connection, the crawler's one-shot connections are left out
+	std::vector<std::pair<unsigned long, unsigned long>> outbound;
+	for(const Node::ptr& node : onlineNodes) {
+		const Node::vector& inbound = node->getInboundConnections();
+		for(const Node::ptr& peer : node->getConnections()) {
+			if(peer->getIndex() != NOINDEX && !nodeInVector(peer, inbound)) {
+				outbound.push_back(std::make_pair(node->getIndex(), peer->getIndex()));
+			}
+		}
+	}
+	std::sort(std::begin(outbound), std::end(outbound));
+
+	file << "connections " << outbound.size() << std::endl;
+	for(auto& connection : outbound) {
+		file << connection.first << " " << connection.second << "\n";
+	}
+
+	file << "known " << allNodes.size() << std::endl;
+	std::vector<unsigned long> known;
+	for(const Node::ptr& node : allNodes) {
+		known.clear();
+		for(const Node::ptr& k : node->getKnownNodes()) {
+			if(k->getIndex() != NOINDEX) {
+				known.push_back(k->getIndex());
+			}
+		}
+		std::sort(std::begin(known), std::end(known));
+		file << node->getIndex() << " " << known.size();
+		for(unsigned long k : known) {
+			file << " " << k;
+		}
+		file << "\n";
+	}
+	return file.good();
+}
+
+void Simulation::run(unsigned long endTime, int churn)
+{
 	// main simulation loop
 	short crawlerClock = 0; // crawler stays connected 10 seconds
 	short churnClock = 0; 
 	for (; getSimClock() < endTime; tickSimClock()) {
-		for (Node::ptr node : bootSchedule[getSimClock()]) {
-			node -> start();
+		// the branches continue from here, the parent only waits for their results
+		if(!options.variants.empty() && getSimClock() == options.branchTime && branch(churn)) {
+			break;
 		}
 
-		for (auto it : onlineNodes) {
-			it->maintenance();
+		for (const Node::ptr& node : bootSchedule[getSimClock()]) {
+			if(isLocalNode(node)) {
+				node -> start();
+			}
+		}
+
+		if(crawl != nullptr) {
+			ingestCrawl();
+		}
+
+		auto wakeUps = wakeUpSchedule.find(getSimClock());
+		if(wakeUps != std::end(wakeUpSchedule)) {
+			for (const Node::ptr& node : wakeUps->second) {
+				node->wakeUp();
+			}
+			wakeUpSchedule.erase(wakeUps);
 		}
 
+		// only nodes with pending work run their maintenance
+		maintenanceBatch.swap(pendingMaintenance);
+		for (const Node::ptr& node : maintenanceBatch) {
+			node->maintenance();
+		}
+		maintenanceBatch.clear();
+
 		if(churn > 0 && churnClock == 100) {
 			//! \constraint ~every 10 seconds churn peers come and go
+			//! \constraint in a sharded simulation every worker only churns the picked nodes it owns
 			short count = rand() % churn;
 			for (short s = 0; s < count; ++s) {
 				Node::ptr n = randomNodeOfVector(onlineNodes);
-				if (n != nullptr) {
+				if (n != nullptr && isLocalNode(n)) {
 					n->stop();
 				}
 			}
 
 			count = rand() % churn;
 			for (short s = 0; s < count; ++s) {
-				n = randomNodeOfVector(offlineNodes);
-				if (n != nullptr) {
+				Node::ptr n = randomNodeOfVector(offlineNodes);
+				if (n != nullptr && isLocalNode(n)) {
 					n->start();
 				}
 			}
 		}
+		// the clock wraps every 10 seconds, with or without churn
+		if(churnClock == 100) {
+			churnClock = 0;
+		}
 		churnClock++;
 
 		if(crawlerClock == 100) {
@@ -79,29 +406,303 @@ Simulation::Simulation(unsigned int numberOfServerNodes, unsigned int numberOfCl
 			crawlerClock = 0;
 		}
 		crawlerClock++;
+
+		// deliver the messages sent during this tick
+		bus->deliver();
+
+		if(liveStats != nullptr && getSimClock() % options.liveStatsInterval == 0) {
+			printLiveStats();
+		}
+
+		if(addrCoverage != nullptr && getSimClock() % ADDRCOVERAGEINTERVAL == 0) {
+			addrCoverage->sample(getSimClock());
+		}
+
+		if(statsExport != nullptr && getSimClock() % STATSEXPORTINTERVAL == 0) {
+			publishStats(endTime, false);
+		}
+
+		if(convergence != nullptr && getSimClock() % CONVERGENCESAMPLEINTERVAL == 0 && checkConvergence()) {
+			break;
+		}
+
+		// at the end of a time window, exchange the traffic with the other shards
+		if(shard != nullptr && (getSimClock() + 1) % shard->getWindow() == 0) {
+			shard->exchange(this);
+			bus->deliver();
+		}
+
+		// the temporaries of this tick are gone, the next one reuses their memory
+		arena->reset();
+	}
+
+	if(statsExport != nullptr) {
+		publishStats(endTime, true);
+	}
+}
+
+bool Simulation::checkConvergence()
+{
+	//! \constraint the topology can't converge while nodes are still joining for the first time, the nodes of the command line join over the whole run, so a run from scratch rarely ends early
+	if(getSimClock() < lastBootTime) return false;
+
+	bool converged = convergence->sample(getSimClock(), onlineNodes);
+	if(converged) {
+		std::cout << "Converged at " << getSimClock() << ": churn rate " << convergence->getChurnRate() << ", degree drift " << convergence->getDegreeDrift() << ", clustering change " << convergence->getClusteringChange() << std::endl;
 	}
+	return converged;
+}
+
+void Simulation::printLiveStats()
+{
+	std::cout << "Live stats at " << getSimClock() << ": " << liveStats->getEdges() << " edges, " << liveStats->getTriangles() << " triangles, transitivity " << liveStats->getTransitivity() << ", mean clustering " << liveStats->getMeanClustering() << ", mean degree " << liveStats->getMeanDegree() << ", max degree " << liveStats->getMaxDegree() << std::endl;
+}
 
-	for(Node::ptr n : onlineNodes) {
-		if((n->getConnections()).empty()) {
-			std::cout << n->getID() << " has no connections!!" << std::endl;
+void Simulation::printAddrCoverage()
+{
+	const std::vector<CoverageCurve>& curves = addrCoverage->getCurves();
+	auto age = [](unsigned long ticks) {
+		unsigned long seconds = ticks / 10;
+		if(seconds >= 3600 && seconds % 3600 == 0) return std::to_string(seconds / 3600) + "h";
+		if(seconds >= 60 && seconds % 60 == 0) return std::to_string(seconds / 60) + "m";
+		return std::to_string(seconds) + "s";
+	};
+
+	std::cout << std::endl;
+	std::cout << "\t\tAddress Coverage (" << curves.size() << " new servers, share of the online nodes)" << std::endl;
+	std::cout << "\t\t---------------------------------------------------------" << std::endl;
+	std::cout << std::setw(20) << "Age" << "\t | " << std::setw(10) << "Mean" << " | " << std::setw(10) << "Min" << " | " << std::setw(10) << "Max" << " | " << std::setw(10) << "Servers" << std::endl;
+	for(unsigned int a = 0; a < COVERAGEAGES; ++a) {
+		double sum = 0, min = 1, max = 0;
+		unsigned long count = 0;
+		for(const CoverageCurve& curve : curves) {
+			if(curve.coverage[a] < 0) continue;
+			sum += curve.coverage[a];
+			min = std::min(min, curve.coverage[a]);
+			max = std::max(max, curve.coverage[a]);
+			count++;
 		}
+		if(count == 0) break;
+		std::cout << std::setw(20) << age(COVERAGEAGE[a]) << "\t | " << std::setw(10) << sum / count << " | " << std::setw(10) << min << " | " << std::setw(10) << max << " | " << std::setw(10) << count << std::endl;
 	}
 
-	// generate the graph
+	// the time to reach a share only averages the servers which reached it
+	for(unsigned int s = 0; s < COVERAGESHARES; ++s) {
+		double sum = 0;
+		unsigned long count = 0;
+		for(const CoverageCurve& curve : curves) {
+			if(curve.reached[s] == NOTREACHED) continue;
+			sum += curve.reached[s] / 10.0;
+			count++;
+		}
+		std::string share = std::to_string((int) std::round(COVERAGESHARE[s] * 100)) + "% After (s)";
+		std::cout << std::setw(20) << share << "\t | " << std::setw(10) << (count > 0 ? sum / count : 0) << " | " << std::setw(10) << "" << " | " << std::setw(10) << "" << " | " << std::setw(10) << count << std::endl;
+	}
+}
+
+void Simulation::openStatsExport(std::string name, unsigned int shard)
+{
+	statsExport = std::make_shared<StatsExport>(name, shard, options.shards);
+	if(!statsExport->isOpen()) {
+		std::cerr << "Could not create the shared memory " << name << ", not publishing the statistics." << std::endl;
+		statsExport = nullptr;
+	}
+}
+
+void Simulation::publishStats(unsigned long endTime, bool finished)
+{
+	StatsBlock stats = {};
+	stats.simClock = getSimClock();
+	stats.endTime = endTime;
+	stats.onlineNodes = onlineNodes.size();
+	stats.offlineNodes = offlineNodes.size();
+	stats.connectionEnds = connectionEnds;
+	stats.versionMessages = bus->getPosted(Message::VERSION);
+	stats.getaddrMessages = bus->getPosted(Message::GETADDR);
+	stats.addrMessages = bus->getPosted(Message::ADDR);
+	stats.addrEntries = bus->getPostedAddrs();
+	stats.finished = finished;
+	statsExport->publish(stats);
+}
+
+bool Simulation::branch(int& churn)
+{
+	branchResults = std::make_shared<BranchResults>(options.variants.size());
+	if(!branchResults->isOpen()) {
+		std::cerr << "Could not map the results of the branches, not branching." << std::endl;
+		branchResults = nullptr;
+		return false;
+	}
+
+	// common random numbers: all branches continue with the same ones, so they only differ by their variant
+	unsigned int branchSeed = rand();
+	std::cout.flush();
+	for(unsigned int i = 0; i < options.variants.size(); ++i) {
+		pid_t pid = fork();
+		if(pid < 0) {
+			perror("fork");
+			break;
+		}
+		if(pid == 0) {
+			branchIndex = i;
+			branchProcesses.clear();
+
+			// only the comparison is printed, the logs of the branches would interleave
+			int devNull = open("/dev/null", O_WRONLY);
+			if(devNull >= 0) {
+				dup2(devNull, STDOUT_FILENO);
+				close(devNull);
+			}
+			liveStats = nullptr;
+			statsExport = nullptr;
+
+			srand(branchSeed);
+			applyVariant(options.variants[i], churn);
+			branchAddrMessages = bus->getPosted(Message::ADDR);
+			return false;
+		}
+		branchProcesses.push_back(pid);
+	}
+	return true;
+}
+
+void Simulation::applyVariant(const BranchVariant& variant, int& churn)
+{
+	if(variant.churn >= 0) {
+		churn = variant.churn;
+	}
+
+	if(variant.maxOutbound > 0) {
+		//! \constraint a lower limit applies to the existing connections as well, a higher one is filled by the maintenance
+		options.maxOutbound = variant.maxOutbound;
+		Node::vector nodes = onlineNodes;
+		for(const Node::ptr& node : nodes) {
+			node->trimOutbound(options.maxOutbound);
+			node->requestMaintenance();
+		}
+	}
+
+	if(variant.attack > 0) {
+		// the best connected nodes go offline at once, the churn may bring them back like any other node
+		Node::vector nodes = onlineNodes;
+		std::stable_sort(std::begin(nodes), std::end(nodes), [](const Node::ptr& a, const Node::ptr& b) {
+			return a->getConnections().size() > b->getConnections().size();
+		});
+		unsigned long count = std::round(variant.attack * nodes.size());
+		for(unsigned long i = 0; i < count; ++i) {
+			nodes[i]->stop();
+		}
+	}
+}
+
+void Simulation::summarizeBranch(BranchResult& result)
+{
 	Graph g(onlineNodes.size());
 	nodeVectorToGraph(onlineNodes, g);
+	CSRGraph csr(g);
+	MetricsEngine engine(options.threads);
+	GraphMetrics metrics = engine.calculate(csr, DEGREE | COMPONENTS);
+	unsigned long passes;
 
-	// generate random graph for comparison
-	Graph randomGraph;
-	boost::random::mt19937 rng;
-	boost::generate_random_graph(randomGraph, num_vertices(g), num_edges(g), rng, false, false);
+	result.onlineNodes = onlineNodes.size();
+	result.edges = num_edges(g);
+	result.meanDegree = metrics.meanDegree;
+	result.clustering = calculateClustering(g);
+	result.diameter = calculateDiameter(csr, passes, options.threads);
+	result.meanDistance = options.distanceHistogram ? calculateDistanceHistogram(csr).getMean() : 0;
+	result.components = metrics.components;
+	result.largestComponent = metrics.largestComponent;
+	result.addrMessages = bus->getPosted(Message::ADDR) - branchAddrMessages;
+}
 
-	// start the calculations and print the results
-	calculateAndPrintData(g, randomGraph);
-	
-	// write the graph
-	if(!graphFilePath.empty()) {
-		writeGraphs(g, randomGraph, graphFilePath);
+void Simulation::finishBranch()
+{
+	if(branchIndex != NOINDEX) {
+		BranchResult& result = branchResults->at(branchIndex);
+		summarizeBranch(result);
+		result.done = 1;
+		std::cout.flush();
+		_exit(EXIT_SUCCESS);
+	}
+
+	// the parent reads the results once all branches exited
+	for(pid_t pid : branchProcesses) {
+		waitpid(pid, nullptr, 0);
+	}
+
+	std::cout << std::endl << std::endl;
+	std::cout << "\t\tBranches at tick " << options.branchTime << " (common random numbers)" << std::endl;
+	std::cout << "\t\t-----------------------------------------" << std::endl;
+	std::cout << std::setw(20) << "Variant" << "\t | " << std::setw(8) << "Online" << " | " << std::setw(8) << "Edges" << " | " << std::setw(8) << "Degree" << " | " << std::setw(10) << "Clustering" << " | " << std::setw(8) << "Diameter" << " | " << std::setw(8) << "Distance" << " | " << std::setw(10) << "Components" << " | " << std::setw(8) << "Largest" << " | " << std::setw(10) << "Addr Msgs" << std::endl;
+	for(unsigned int i = 0; i < options.variants.size(); ++i) {
+		const BranchResult& result = branchResults->at(i);
+		std::cout << std::setw(20) << options.variants[i].name << "\t | ";
+		if(!result.done) {
+			std::cout << "failed" << std::endl;
+			continue;
+		}
+		std::cout << std::setw(8) << result.onlineNodes << " | " << std::setw(8) << result.edges << " | " << std::setw(8) << result.meanDegree << " | " << std::setw(10) << result.clustering << " | " << std::setw(8) << result.diameter << " | " << std::setw(8) << result.meanDistance << " | " << std::setw(10) << result.components << " | " << std::setw(8) << result.largestComponent << " | " << std::setw(10) << result.addrMessages << std::endl;
+	}
+}
+
+void Simulation::runShards(unsigned long endTime, int churn, Graph& g)
+{
+	shard = std::make_shared<ShardContext>(options.shards, options.shardWindow);
+
+	// the workers inherit the population, every worker continues with its own random numbers
+	unsigned int workerSeed = rand();
+	std::vector<pid_t> workers;
+	std::cout.flush();
+	for (unsigned int i = 0; i < options.shards; ++i) {
+		pid_t pid = fork();
+		if(pid < 0) {
+			perror("fork");
+			exit(EXIT_FAILURE);
+		}
+		if(pid == 0) {
+			srand(workerSeed + i);
+			shard->attach(i);
+			bus->setShardContext(shard);
+			seed = std::make_shared<DNSSeeder>(this);
+			if(!options.statsName.empty()) {
+				openStatsExport(options.statsName + "-" + std::to_string(i), i);
+			}
+			run(endTime, churn);
+			shard->sendTopology(onlineNodes);
+			std::cout.flush();
+			_exit(EXIT_SUCCESS);
+		}
+		workers.push_back(pid);
+	}
+
+	std::vector<std::vector<uint32_t>> adjacency;
+	std::vector<bool> online;
+	if(!shard->collectTopology(workers, allNodes.size(), adjacency, online)) {
+		for(pid_t pid : workers) {
+			kill(pid, SIGKILL);
+		}
+		exit(EXIT_FAILURE);
+	}
+
+	// merge the topology, the vertices are the online nodes in population order
+	std::vector<Vertex> vertexOfNode(allNodes.size());
+	for(unsigned long i = 0; i < allNodes.size(); ++i) {
+		if(online[i]) {
+			vertexOfNode[i] = boost::add_vertex(g);
+			g[vertexOfNode[i]].server = allNodes[i]->getRole() == Node::SERVER;
+		}
+	}
+	for(unsigned long i = 0; i < allNodes.size(); ++i) {
+		if(!online[i]) continue;
+		if(adjacency[i].empty()) {
+			std::cout << allNodes[i]->getID() << " has no connections!!" << std::endl;
+		}
+		for(uint32_t to : adjacency[i]) {
+			if(to == i || !online[to]) continue;
+			if(!boost::edge(vertexOfNode[i], vertexOfNode[to], g).second) {
+				boost::add_edge(vertexOfNode[i], vertexOfNode[to], g);
+			}
+		}
 	}
 }
 
@@ -122,36 +723,384 @@ unsigned long Simulation::tickSimClock()
 	return ++Simulation::simClock;
 }
 
-void Simulation::calculateAndPrintData(Graph& g, Graph& randomGraph)
+void Simulation::generateRandomGraph(unsigned long vertices, unsigned long edges, Graph& randomGraph)
 {
-	// calculate clustering coefs
-	float cc =calculateClustering(g);
-	float randomCC = calculateClustering(randomGraph);
+	boost::random::mt19937 rng(RANDOMGRAPHSEED);
+	boost::generate_random_graph(randomGraph, vertices, edges, rng, false, false);
+}
 
-	// calculate mean geodesic path
-	DistanceMatrix distances = calculateDistances(g);
-	DistanceMatrix randomDistances = calculateDistances(randomGraph);
+void Simulation::analyse(Graph& g, bool build, std::string graphFilePath)
+{
+	//! \constraint the random graph only needs the vertex and edge count, so it is generated while the graph of the topology is built
+	unsigned long vertices = build ? onlineNodes.size() : num_vertices(g);
+	unsigned long edges = build ? countGraphEdges(onlineNodes) : num_edges(g);
 
-	float meanGeodesic = calculateMeanGeodesic(g, distances);
-	float randomMeanGeodesic = calculateMeanGeodesic(randomGraph, randomDistances);
+	BaselineResults results, baseline;
+	BaselineCache::ptr cache;
+	std::string key = BaselineCache::makeKey(vertices, edges, RANDOMGRAPHGENERATOR, RANDOMGRAPHSEED);
+	if(!options.baselineCacheDir.empty()) {
+		cache = std::make_shared<BaselineCache>(options.baselineCacheDir);
+		cache->load(key, baseline);
+	}
 
-	// calculate the diameter:
-	unsigned long diameter = calculateDiameter(g, distances);
-	unsigned long randomDiameter = calculateDiameter(randomGraph, randomDistances);
+	// only what this run needs and the cache lacks is calculated for the random graph
+	bool clustering = !baseline.hasClustering;
+	bool diameter = !baseline.hasDiameter;
+	bool distances = options.distanceHistogram && !baseline.hasDistances;
+	unsigned int metrics = options.metrics & ~baseline.metricsMask;
+	//! \constraint the origins are drawn from the run's random numbers unless a seed is given, drawing them after the run leaves the simulation unchanged
+	if(options.propagationSources > 0 && !options.fixedPropagationSeed) {
+		options.propagationSeed = rand();
+	}
+	bool propagation = options.propagationSources > 0 && baseline.propagationKey != propagationKey();
+	bool resilience = options.resilienceRuns > 0 && baseline.resilienceRuns != options.resilienceRuns;
+	bool spectrum = options.spectrum && !baseline.hasSpectrum;
+	bool calculateBaseline = clustering || diameter || distances || metrics != 0 || propagation || resilience || spectrum;
+	if(!calculateBaseline) {
+		std::cout << "Using the cached random graph " << key << "." << std::endl;
+	}
+
+	// every analysis is a task, it starts as soon as the graph it reads is ready
+	TaskGraph tasks(options.threads);
+	Graph randomGraph;
+	std::unique_ptr<CSRGraph> csr, randomCSR;
+	ResilienceCurve serverRemoval;
+	EclipseStats eclipse, randomEclipse;
+
+	TaskGraph::Task built = tasks.add([&]() {
+		if(build) {
+			g = Graph(vertices);
+			nodeVectorToGraph(onlineNodes, g);
+		}
+	});
+	TaskGraph::Task generated = tasks.add([&]() {
+		if(calculateBaseline || !graphFilePath.empty()) {
+			generateRandomGraph(vertices, edges, randomGraph);
+		}
+	});
+
+	// the files are written while the graphs are analysed
+	if(!graphFilePath.empty()) {
+		tasks.add([&]() { writeGraph(graphFilePath, g); }, {built});
+		tasks.add([&]() { writeGraph(graphFilePath + ".random.gv", randomGraph); }, {generated});
+	}
+
+	// the eclipse attack reads the address tables, not the graph, and isn't cached as they differ from run to run
+	if(options.eclipseTrials > 0) {
+		tasks.add([&]() {
+			EclipseEngine engine(onlineNodes, getMaxOutbound(), options.threads);
+			eclipse = engine.estimate(options.eclipseTrials, 0);
+			engine.randomizeTables(RANDOMGRAPHSEED);
+			randomEclipse = engine.estimate(options.eclipseTrials, 0);
+		});
+	}
+
+	// the topology
+	tasks.add([&]() { results.clustering = calculateClustering(g); }, {built});
+	TaskGraph::Task converted = tasks.add([&]() { csr.reset(new CSRGraph(g)); }, {built});
+	std::vector<TaskGraph::Task> analyses;
+	analyses.push_back(tasks.add([&]() { results.diameter = calculateDiameter(*csr, results.diameterPasses, options.threads); }, {converted}));
+	if(options.distanceHistogram) {
+		analyses.push_back(tasks.add([&]() { results.distances = calculateDistances(*csr, options.distanceSpillPath); }, {converted}));
+	}
+	if(options.metrics != 0) {
+		analyses.push_back(tasks.add([&]() {
+			MetricsEngine engine(options.threads);
+			results.metrics = engine.calculate(*csr, options.metrics);
+		}, {converted}));
+	}
+	if(options.propagationSources > 0) {
+		analyses.push_back(tasks.add([&]() { results.propagation = calculatePropagation(*csr); }, {converted}));
+	}
+	if(options.resilienceRuns > 0) {
+		analyses.push_back(tasks.add([&]() {
+			ResilienceEngine engine(*csr, options.threads);
+			std::vector<bool> servers(csr->numVertices());
+			for(uint32_t v = 0; v < servers.size(); ++v) {
+				servers[v] = g[v].server;
+			}
+			results.randomRemoval = engine.removeRandomly(options.resilienceRuns, 0);
+			results.degreeRemoval = engine.removeInOrder(engine.degreeOrder());
+			serverRemoval = engine.removeRandomly(options.resilienceRuns, 0, servers);
+		}, {converted}));
+	}
+	if(options.spectrum) {
+		analyses.push_back(tasks.add([&]() {
+			SpectralEngine engine(*csr, options.threads);
+			results.spectrum = engine.calculate();
+		}, {converted}));
+	}
+	tasks.add([&]() { csr.reset(); }, analyses);
+
+	// the random graph
+	if(calculateBaseline) {
+		if(clustering) {
+			tasks.add([&]() {
+				baseline.clustering = calculateClustering(randomGraph);
+				baseline.hasClustering = true;
+			}, {generated});
+		}
+		TaskGraph::Task randomConverted = tasks.add([&]() { randomCSR.reset(new CSRGraph(randomGraph)); }, {generated});
+		std::vector<TaskGraph::Task> randomAnalyses;
+		if(diameter) {
+			randomAnalyses.push_back(tasks.add([&]() {
+				baseline.diameter = calculateDiameter(*randomCSR, baseline.diameterPasses, options.threads);
+				baseline.hasDiameter = true;
+			}, {randomConverted}));
+		}
+		if(distances) {
+			randomAnalyses.push_back(tasks.add([&]() {
+				std::string spillPath = options.distanceSpillPath;
+				baseline.distances = calculateDistances(*randomCSR, spillPath.empty() ? spillPath : spillPath + ".random");
+				baseline.hasDistances = true;
+			}, {randomConverted}));
+		}
+		if(metrics != 0) {
+			randomAnalyses.push_back(tasks.add([&]() {
+				MetricsEngine engine(options.threads);
+				mergeMetrics(baseline.metrics, engine.calculate(*randomCSR, metrics), metrics);
+				baseline.metricsMask |= metrics;
+			}, {randomConverted}));
+		}
+		if(propagation) {
+			randomAnalyses.push_back(tasks.add([&]() {
+				baseline.propagation = calculatePropagation(*randomCSR);
+				baseline.propagationKey = propagationKey();
+			}, {randomConverted}));
+		}
+		if(resilience) {
+			randomAnalyses.push_back(tasks.add([&]() {
+				ResilienceEngine engine(*randomCSR, options.threads);
+				baseline.randomRemoval = engine.removeRandomly(options.resilienceRuns, 0);
+				baseline.degreeRemoval = engine.removeInOrder(engine.degreeOrder());
+				baseline.resilienceRuns = options.resilienceRuns;
+			}, {randomConverted}));
+		}
+		if(spectrum) {
+			randomAnalyses.push_back(tasks.add([&]() {
+				SpectralEngine engine(*randomCSR, options.threads);
+				baseline.spectrum = engine.calculate();
+				baseline.hasSpectrum = true;
+			}, {randomConverted}));
+		}
+		tasks.add([&]() { randomCSR.reset(); }, randomAnalyses);
+	}
 
+	tasks.run();
+
+	// the random graph was generated from the counted edges, so it only matches the topology if the built graph has as many
+	bool matched = num_edges(g) == edges;
+	if(!matched) {
+		std::cerr << "The graph of the topology has " << num_edges(g) << " edges, but " << edges << " were counted, the random graph doesn't match it and isn't cached." << std::endl;
+	}
+
+	if(matched && calculateBaseline && cache != nullptr && !cache->store(key, baseline)) {
+		std::cerr << "Could not write the random graph " << key << " to the baseline cache." << std::endl;
+	}
+
+	printData(results, serverRemoval, baseline);
+	if(options.eclipseTrials > 0) {
+		printEclipse(eclipse, randomEclipse);
+	}
+}
+
+std::string Simulation::propagationKey()
+{
+	return std::to_string(options.propagationSources) + ":" + std::to_string(options.minLatency) + ":" + std::to_string(options.maxLatency) + ":" + std::to_string(options.propagationSeed);
+}
+
+void Simulation::printData(BaselineResults& results, ResilienceCurve& serverRemoval, BaselineResults& baseline)
+{
 	// print results:
 	std::cout << std::endl << std::endl;
 	std::cout << "\t\tStatistics!" << std::endl;
 	std::cout << "\t\t-----------" << std::endl;
 	std::cout << std::setw(20) << "" << "\t | " << std::setw(10) << "Bitcoin" << " | " << std::setw(10) << "Random Graph" << std::endl;
-	std::cout << std::setw(20) << "Clustering Coef" << "\t | " << std::setw(10) << cc << " | " << std::setw(10) << randomCC << std::endl;
+	std::cout << std::setw(20) << "Clustering Coef" << "\t | " << std::setw(10) << results.clustering << " | " << std::setw(10) << baseline.clustering << std::endl;
+
+	std::cout << std::setw(20) << "Diameter" << "\t | " << std::setw(10) << results.diameter << " | " << std::setw(10) << baseline.diameter << std::endl;
+	std::cout << std::setw(20) << "Diameter BFS Passes" << "\t | " << std::setw(10) << results.diameterPasses << " | " << std::setw(10) << baseline.diameterPasses << std::endl;
+
+	if(options.distanceHistogram) {
+		printDistances(results.distances, baseline.distances);
+	}
+
+	if(options.metrics != 0) {
+		printMetrics(results.metrics, baseline.metrics);
+	}
+
+	if(options.propagationSources > 0) {
+		printPropagation(results.propagation, baseline.propagation);
+	}
+
+	if(options.resilienceRuns > 0) {
+		printResilience(results, serverRemoval, baseline);
+	}
+
+	if(options.spectrum) {
+		printSpectrum(results.spectrum, baseline.spectrum);
+	}
+}
+
+void Simulation::printSpectrum(SpectralStats& stats, SpectralStats& randomStats)
+{
+	std::cout << std::endl;
+	std::cout << "\t\tSpectrum (largest component)" << std::endl;
+	std::cout << "\t\t----------------------------" << std::endl;
+	std::cout << std::setw(20) << "" << "\t | " << std::setw(10) << "Bitcoin" << " | " << std::setw(10) << "Random Graph" << std::endl;
+	std::cout << std::setw(20) << "Vertices" << "\t | " << std::setw(10) << stats.vertices << " | " << std::setw(10) << randomStats.vertices << std::endl;
+	std::cout << std::setw(20) << "Algebraic Conn." << "\t | " << std::setw(10) << stats.algebraicConnectivity << " | " << std::setw(10) << randomStats.algebraicConnectivity << std::endl;
+	std::cout << std::setw(20) << "Spectral Gap" << "\t | " << std::setw(10) << stats.spectralGap << " | " << std::setw(10) << randomStats.spectralGap << std::endl;
+	std::cout << std::setw(20) << "Lanczos Iterations" << "\t | " << std::setw(10) << stats.iterations << " | " << std::setw(10) << randomStats.iterations << std::endl;
+	if(!stats.converged || !randomStats.converged) {
+		std::cout << "The Lanczos iteration didn't converge, the eigenvalues are estimates." << std::endl;
+	}
+}
+
+void Simulation::printResilience(BaselineResults& results, ResilienceCurve& serverRemoval, BaselineResults& baseline)
+{
+	//! \constraint the vertices of the random graph have no roles and are exchangeable, so removing the servers first is a random removal there
+	std::string names[] = {"Random Removal", "Highest Degree First", "Servers First"};
+	ResilienceCurve* curves[] = {&results.randomRemoval, &results.degreeRemoval, &serverRemoval};
+	ResilienceCurve* randomCurves[] = {&baseline.randomRemoval, &baseline.degreeRemoval, &baseline.randomRemoval};
+	for(unsigned int c = 0; c < 3; ++c) {
+		std::cout << std::endl;
+		std::cout << "\t\tGiant Component, " << names[c] << " (fraction of vertices)" << std::endl;
+		std::cout << "\t\t------------------------------------------------" << std::endl;
+		std::cout << std::setw(20) << "Removed" << "\t | " << std::setw(10) << "Bitcoin" << " | " << std::setw(10) << "Random Graph" << std::endl;
+		for(unsigned int f = 0; f < REMOVALFRACTIONS; ++f) {
+			std::string removed = std::to_string((int) std::round(REMOVALFRACTION[f] * 100)) + "%";
+			std::cout << std::setw(20) << removed << "\t | " << std::setw(10) << curves[c]->giant[f] << " | " << std::setw(10) << randomCurves[c]->giant[f] << std::endl;
+		}
+		std::cout << std::setw(20) << "Robustness" << "\t | " << std::setw(10) << curves[c]->robustness << " | " << std::setw(10) << randomCurves[c]->robustness << std::endl;
+	}
+}
+
+void Simulation::printEclipse(EclipseStats& stats, EclipseStats& randomStats)
+{
+	std::cout << std::endl;
+	std::cout << "\t\tEclipse Attack (" << stats.estimates[0].trials << " trials, probability and 95% interval)" << std::endl;
+	std::cout << "\t\t-------------------------------------------------------" << std::endl;
+	std::cout << std::setw(20) << "Attacker Servers" << "\t | " << std::setw(10) << "Bitcoin" << " | " << std::setw(10) << "Lower" << " | " << std::setw(10) << "Upper";
+	std::cout << " | " << std::setw(10) << "Random" << " | " << std::setw(10) << "Lower" << " | " << std::setw(10) << "Upper" << std::endl;
+	for(unsigned int f = 0; f < ECLIPSEFRACTIONS; ++f) {
+		EclipseEstimate& estimate = stats.estimates[f];
+		EclipseEstimate& randomEstimate = randomStats.estimates[f];
+		std::string fraction = std::to_string((int) std::round(ECLIPSEFRACTION[f] * 100)) + "%";
+		std::cout << std::setw(20) << fraction << "\t | " << std::setw(10) << estimate.probability << " | " << std::setw(10) << estimate.lower << " | " << std::setw(10) << estimate.upper;
+		std::cout << " | " << std::setw(10) << randomEstimate.probability << " | " << std::setw(10) << randomEstimate.lower << " | " << std::setw(10) << randomEstimate.upper << std::endl;
+	}
+	std::cout << std::setw(20) << "Victims" << "\t | " << std::setw(10) << stats.victims << std::endl;
+	std::cout << std::setw(20) << "Mean Known Addrs" << "\t | " << std::setw(10) << stats.meanTable << std::endl;
+	std::cout << std::setw(20) << "Stale Known Addrs" << "\t | " << std::setw(10) << stats.staleShare << " | " << std::setw(10) << "" << " | " << std::setw(10) << "" << " | " << std::setw(10) << randomStats.staleShare << std::endl;
+	std::cout << std::setw(20) << "Full Servers" << "\t | " << std::setw(10) << stats.fullShare << " | " << std::setw(10) << "" << " | " << std::setw(10) << "" << " | " << std::setw(10) << randomStats.fullShare << std::endl;
+}
+
+void Simulation::printDistances(DistanceHistogram& distances, DistanceHistogram& randomDistances)
+{
+	std::cout << std::setw(20) << "Mean Geodesic Dist" << "\t | " << std::setw(10) << distances.getMean() << " | " << std::setw(10) << randomDistances.getMean() << std::endl;
+	std::cout << std::setw(20) << "50th Pct Distance" << "\t | " << std::setw(10) << distances.getPercentile(0.5) << " | " << std::setw(10) << randomDistances.getPercentile(0.5) << std::endl;
+	std::cout << std::setw(20) << "90th Pct Distance" << "\t | " << std::setw(10) << distances.getPercentile(0.9) << " | " << std::setw(10) << randomDistances.getPercentile(0.9) << std::endl;
+	std::cout << std::setw(20) << "99th Pct Distance" << "\t | " << std::setw(10) << distances.getPercentile(0.99) << " | " << std::setw(10) << randomDistances.getPercentile(0.99) << std::endl;
+	std::cout << std::setw(20) << "Disconnected Pairs" << "\t | " << std::setw(10) << distances.getDisconnectedPairs() << " | " << std::setw(10) << randomDistances.getDisconnectedPairs() << std::endl;
+
+	// print the distributions
+	std::cout << std::endl;
+	std::cout << "\t\tHop Distances (ordered pairs)" << std::endl;
+	std::cout << "\t\t-----------------------------" << std::endl;
+	uint32_t maxHops = std::max(distances.getMaxHops(), randomDistances.getMaxHops());
+	for(uint32_t hops = 1; hops <= maxHops; ++hops) {
+		std::cout << std::setw(20) << hops << "\t | " << std::setw(10) << distances.getPairs(hops) << " | " << std::setw(10) << randomDistances.getPairs(hops) << std::endl;
+	}
+}
+
+PropagationStats Simulation::calculatePropagation(const CSRGraph& g)
+{
+	MetricsEngine engine(options.threads);
+	PropagationEngine propagation(g, options.minLatency, options.maxLatency);
+
+	//! \constraint both graphs have the same number of vertices, so they flood from the same origins
+	std::vector<uint32_t> sources = propagation.pickSources(options.propagationSources, options.propagationSeed);
+	return propagation.simulate(sources, engine.getThreads());
+}
+
+void Simulation::printPropagation(PropagationStats& stats, PropagationStats& randomStats)
+{
+	std::cout << std::endl;
+	std::cout << "\t\tPropagation (" << stats.sources << " origins, seed " << options.propagationSeed << ", ms)" << std::endl;
+	std::cout << "\t\t-----------------------------" << std::endl;
+	std::cout << std::setw(20) << "" << "\t | " << std::setw(10) << "Bitcoin" << " | " << std::setw(10) << "Random Graph" << std::endl;
+	for(unsigned int c = 0; c < PROPAGATIONCOVERAGES; ++c) {
+		std::string coverage = std::to_string((int) std::round(PROPAGATIONCOVERAGE[c] * 100)) + "%";
+		std::cout << std::setw(20) << coverage + " Mean Time" << "\t | " << std::setw(10) << stats.meanTime[c] << " | " << std::setw(10) << randomStats.meanTime[c] << std::endl;
+		std::cout << std::setw(20) << coverage + " Max Time" << "\t | " << std::setw(10) << stats.maxTime[c] << " | " << std::setw(10) << randomStats.maxTime[c] << std::endl;
+		std::cout << std::setw(20) << coverage + " Not Reached" << "\t | " << std::setw(10) << stats.unreached[c] << " | " << std::setw(10) << randomStats.unreached[c] << std::endl;
+	}
+}
 
-	std::cout << std::setw(20) << "Mean Geodesic Dist" << "\t | " << std::setw(10) << meanGeodesic << " | " << std::setw(10) << randomMeanGeodesic << std::endl;
+void Simulation::printMetrics(GraphMetrics& metrics, GraphMetrics& randomMetrics)
+{
+	std::cout << std::endl;
+	std::cout << "\t\tStructure Metrics" << std::endl;
+	std::cout << "\t\t-----------------" << std::endl;
+	std::cout << std::setw(20) << "" << "\t | " << std::setw(10) << "Bitcoin" << " | " << std::setw(10) << "Random Graph" << std::endl;
+	if(options.metrics & BETWEENNESS) {
+		std::cout << std::setw(20) << "Max Betweenness" << "\t | " << std::setw(10) << metrics.maxBetweenness << " | " << std::setw(10) << randomMetrics.maxBetweenness << std::endl;
+		std::cout << std::setw(20) << "Mean Betweenness" << "\t | " << std::setw(10) << metrics.meanBetweenness << " | " << std::setw(10) << randomMetrics.meanBetweenness << std::endl;
+	}
+	if(options.metrics & KCORE) {
+		std::cout << std::setw(20) << "Degeneracy" << "\t | " << std::setw(10) << metrics.degeneracy << " | " << std::setw(10) << randomMetrics.degeneracy << std::endl;
+	}
+	if(options.metrics & DEGREE) {
+		std::cout << std::setw(20) << "Mean Degree" << "\t | " << std::setw(10) << metrics.meanDegree << " | " << std::setw(10) << randomMetrics.meanDegree << std::endl;
+		std::cout << std::setw(20) << "Max Degree" << "\t | " << std::setw(10) << metrics.maxDegree << " | " << std::setw(10) << randomMetrics.maxDegree << std::endl;
+	}
+	if(options.metrics & ASSORTATIVITY) {
+		std::cout << std::setw(20) << "Assortativity" << "\t | " << std::setw(10) << metrics.assortativity << " | " << std::setw(10) << randomMetrics.assortativity << std::endl;
+	}
+	if(options.metrics & COMPONENTS) {
+		std::cout << std::setw(20) << "Components" << "\t | " << std::setw(10) << metrics.components << " | " << std::setw(10) << randomMetrics.components << std::endl;
+		std::cout << std::setw(20) << "Largest Component" << "\t | " << std::setw(10) << metrics.largestComponent << " | " << std::setw(10) << randomMetrics.largestComponent << std::endl;
+		std::cout << std::setw(20) << "Isolated Vertices" << "\t | " << std::setw(10) << metrics.isolatedVertices << " | " << std::setw(10) << randomMetrics.isolatedVertices << std::endl;
+	}
+
+	if(options.metrics & KCORE) {
+		std::cout << std::endl;
+		std::cout << "\t\tCore Numbers (vertices)" << std::endl;
+		std::cout << "\t\t-----------------------" << std::endl;
+		uint32_t maxCore = std::max(metrics.degeneracy, randomMetrics.degeneracy);
+		for(uint32_t core = 0; core <= maxCore; ++core) {
+			uint64_t count = core < metrics.coreSizes.size() ? metrics.coreSizes[core] : 0;
+			uint64_t randomCount = core < randomMetrics.coreSizes.size() ? randomMetrics.coreSizes[core] : 0;
+			if(count == 0 && randomCount == 0) continue;
+			std::cout << std::setw(20) << core << "\t | " << std::setw(10) << count << " | " << std::setw(10) << randomCount << std::endl;
+		}
+	}
 
-	std::cout << std::setw(20) << "Diameter" << "\t | " << std::setw(10) << diameter << " | " << std::setw(10) << randomDiameter << std::endl;
+	if(options.metrics & DEGREE) {
+		std::cout << std::endl;
+		std::cout << "\t\tDegrees (vertices)" << std::endl;
+		std::cout << "\t\t------------------" << std::endl;
+		uint32_t maxDegree = std::max(metrics.maxDegree, randomMetrics.maxDegree);
+		for(uint32_t degree = 0; degree <= maxDegree; ++degree) {
+			uint64_t count = degree < metrics.degrees.size() ? metrics.degrees[degree] : 0;
+			uint64_t randomCount = degree < randomMetrics.degrees.size() ? randomMetrics.degrees[degree] : 0;
+			if(count == 0 && randomCount == 0) continue;
+			std::cout << std::setw(20) << degree << "\t | " << std::setw(10) << count << " | " << std::setw(10) << randomCount << std::endl;
+		}
+	}
 }
 
-void Simulation::writeGraphs(Graph& g, Graph& randomGraph, std::string graphFilePath)
+void Simulation::writeGraph(std::string path, Graph& g)
+{
+	std::ofstream file(path);
+	if(file.is_open()) {
+		writeGraph(file, g);
+		file.close();
+	}
+}
+
+void Simulation::writeGraph(std::ostream& file, Graph& g)
 {
 	std::map<std::string,std::string> graph_attr, vertex_attr, edge_attr;
 	graph_attr["ratio"] = "auto";
@@ -159,24 +1108,24 @@ void Simulation::writeGraphs(Graph& g, Graph& randomGraph, std::string graphFile
 	edge_attr["penwidth"] = "0.3";
 	vertex_attr["shape"] = "point";
 
-	std::ofstream graphFile(graphFilePath);
-	std::ofstream randomGraphFile(graphFilePath+=".random.gv");
-	if(graphFile.is_open()) {
-		boost::write_graphviz(graphFile, g, 
-				boost::default_writer(),
-				boost::default_writer(),
-				boost::make_graph_attributes_writer(graph_attr, vertex_attr, edge_attr)
-		);
-		graphFile.close();
-	}
-	if(randomGraphFile.is_open()) {
-		boost::write_graphviz(randomGraphFile, randomGraph, 
+	if(options.layoutIterations == 0) {
+		boost::write_graphviz(file, g, 
 				boost::default_writer(),
 				boost::default_writer(),
 				boost::make_graph_attributes_writer(graph_attr, vertex_attr, edge_attr)
 		);
-		randomGraphFile.close();
+		return;
 	}
+
+	// with the coordinates, graphviz only has to draw the graph (neato -n)
+	CSRGraph csr(g);
+	ForceLayout layout(csr, options.threads);
+	std::vector<LayoutPoint> points = layout.calculate(options.layoutIterations);
+	boost::write_graphviz(file, g, 
+			PositionWriter(points),
+			boost::default_writer(),
+			boost::make_graph_attributes_writer(graph_attr, vertex_attr, edge_attr)
+	);
 }
 
 float Simulation::calculateClustering(Graph& g)
@@ -189,72 +1138,171 @@ float Simulation::calculateClustering(Graph& g)
 	return cc;
 }
 
-DistanceMatrix Simulation::calculateDistances(Graph& g)
+DistanceHistogram Simulation::calculateDistances(const CSRGraph& g, std::string spillPath)
+{
+	if(spillPath.empty()) {
+		return calculateDistanceHistogram(g);
+	}
+
+	std::ofstream spillFile(spillPath);
+	if(!spillFile.is_open()) {
+		std::cerr << "Could not open " << spillPath << ", not spilling the distances." << std::endl;
+		return calculateDistanceHistogram(g);
+	}
+	return calculateDistanceHistogram(g, &spillFile);
+}
+
+void Simulation::connectionOpened(const Node::ptr& node, const Node::ptr& peer)
 {
-	WeightMap wm(boost::get(&EdgeProperty::probability, g));
-	DistanceMatrix distances(boost::num_vertices(g));
-    DistanceMatrixMap dm(distances, g);
-	boost::floyd_warshall_all_pairs_shortest_paths(g, dm, weight_map(wm));
-	return distances;
+	// connections of the crawler aren't part of the topology
+	if(node->getIndex() == NOINDEX || peer->getIndex() == NOINDEX) return;
+
+	connectionEnds++;
+	if(topologyLog != nullptr) {
+		topologyLog->connectionOpened(getSimClock(), node->getIndex(), peer->getIndex());
+	}
+	if(liveStats != nullptr) {
+		liveStats->connectionOpened(node->getIndex(), peer->getIndex());
+	}
+	if(convergence != nullptr) {
+		convergence->connectionChanged();
+	}
 }
 
-float Simulation::calculateMeanGeodesic(Graph& g, DistanceMatrix& distances)
+void Simulation::connectionClosed(const Node::ptr& node, const Node::ptr& peer)
 {
-    DistanceMatrixMap dm(distances, g);
-	GeodesicContainer geodesic(boost::num_vertices(g));
-	GeodesicMap gm(geodesic, g);
-	float mean_geodesic = boost::all_mean_geodesics(g, dm, gm);
-	return mean_geodesic;
+	if(node->getIndex() == NOINDEX || peer->getIndex() == NOINDEX) return;
+
+	connectionEnds--;
+	if(topologyLog != nullptr) {
+		topologyLog->connectionClosed(getSimClock(), node->getIndex(), peer->getIndex());
+	}
+	if(liveStats != nullptr) {
+		liveStats->connectionClosed(node->getIndex(), peer->getIndex());
+	}
+	if(convergence != nullptr) {
+		convergence->connectionChanged();
+	}
 }
 
-unsigned long Simulation::calculateDiameter(Graph& g, DistanceMatrix& distances)
+void Simulation::knownNodeAdded(const Node& knower, const Node& known)
 {
-	unsigned long maxDistance = 0;
-	for(unsigned long i = 0; i < boost::num_vertices(g); ++i) {
-		for(unsigned long j = 0; j < boost::num_vertices(g); ++j) {
-			if(distances[i][j] > maxDistance) maxDistance = distances[i][j];
-		}
+	if(addrCoverage != nullptr) {
+		addrCoverage->learned(knower.getIndex(), known.getIndex());
 	}
-	return maxDistance;
 }
 
-DNSSeeder::ptr Simulation::getDNSSeeder() 
+void Simulation::knownNodeRemoved(const Node& knower, const Node& known)
+{
+	if(addrCoverage != nullptr) {
+		addrCoverage->forgot(knower.getIndex(), known.getIndex());
+	}
+}
+
+const DNSSeeder::ptr& Simulation::getDNSSeeder()
 {
 	return seed;
 }
 
-Node::vector Simulation::getAllNodes() 
+const MessageBus::ptr& Simulation::getMessageBus()
+{
+	return bus;
+}
+
+const ScratchArena::ptr& Simulation::getScratchArena()
+{
+	return arena;
+}
+
+const Node::vector& Simulation::getAllNodes()
 {
 	return allNodes;
 }
 
+const Node::ptr& Simulation::getNode(unsigned long index)
+{
+	return allNodes[index];
+}
+
+bool Simulation::isLocalNode(const Node::ptr& node)
+{
+	return shard == nullptr || shard->isLocal(node);
+}
 
-void Simulation::setNodeOnline(Node::ptr node) 
+unsigned int Simulation::getMaxOutbound() const
 {
-	if(!nodeInVector(node, onlineNodes)) {
+	return options.maxOutbound;
+}
+
+const ShardContext::ptr& Simulation::getShardContext()
+{
+	return shard;
+}
+
+void Simulation::setNodeOnline(const Node::ptr& node) 
+{
+	unsigned long index = node->getIndex();
+	if(onlineSlots[index] == NOINDEX) {
+		onlineSlots[index] = onlineNodes.size();
 		onlineNodes.push_back(node);
+		if(addrCoverage != nullptr) {
+			addrCoverage->nodeOnline(index, node->getRole() == Node::SERVER, getSimClock());
+		}
 	}
-	auto it = findNodeInVector(node, offlineNodes);
-	if(it != std::end(offlineNodes)) {
-		offlineNodes.erase(it);
+	removeFromList(node, offlineNodes, offlineSlots);
+
+	if(shard != nullptr && shard->isLocal(node)) {
+		shard->broadcastState(node, true);
 	}
 }
 
-void Simulation::setNodeOffline(Node::ptr node)
+void Simulation::setNodeOffline(const Node::ptr& node)
 {
-	if(!nodeInVector(node, offlineNodes)) {
+	unsigned long index = node->getIndex();
+	if(offlineSlots[index] == NOINDEX) {
+		offlineSlots[index] = offlineNodes.size();
 		offlineNodes.push_back(node);
 	}
-	auto it = findNodeInVector(node, onlineNodes);
-	if(it != std::end(onlineNodes)) {
-		onlineNodes.erase(it);
+	removeFromList(node, onlineNodes, onlineSlots);
+	if(addrCoverage != nullptr) {
+		addrCoverage->nodeOffline(index);
+	}
+
+	if(shard != nullptr && shard->isLocal(node)) {
+		shard->broadcastState(node, false);
 	}
 }
 
-Node::vector Simulation::getOnlineNodes() {
+void Simulation::removeFromList(const Node::ptr& node, Node::vector& list, std::vector<unsigned long>& slots)
+{
+	//! \constraint node may refer to an entry of list, so it isn't used after the list changed
+	unsigned long index = node->getIndex();
+	unsigned long slot = slots[index];
+	if(slot == NOINDEX) return;
+
+	// move the last node into the free slot
+	Node::ptr last = list.back();
+	list[slot] = last;
+	slots[last->getIndex()] = slot;
+	list.pop_back();
+	slots[index] = NOINDEX;
+}
+
+const Node::vector& Simulation::getOnlineNodes()
+{
 	return onlineNodes;
 }
 
+void Simulation::scheduleMaintenance(const Node::ptr& node)
+{
+	pendingMaintenance.push_back(node);
+}
+
+void Simulation::scheduleWakeUp(const Node::ptr& node, unsigned long time)
+{
+	wakeUpSchedule[time].push_back(node);
+}
+
 int main(int argc, char* argv[]) 
 {
 	// number of server nodes to create
@@ -272,28 +1320,218 @@ int main(int argc, char* argv[])
 	// outpath for the graph
 	std::string graphFilePath;
 
+	// optional settings
+	SimulationOptions options;
+	bool usage = false;
+	static struct option longOptions[] = {
+		{"shards", required_argument, nullptr, 's'},
+		{"shard-window", required_argument, nullptr, 'w'},
+		{"distance-spill", required_argument, nullptr, 'd'},
+		{"no-distances", no_argument, nullptr, 'D'},
+		{"metrics", required_argument, nullptr, 'm'},
+		{"threads", required_argument, nullptr, 't'},
+		{"propagation", required_argument, nullptr, 'p'},
+		{"latency", required_argument, nullptr, 'l'},
+		{"propagation-seed", required_argument, nullptr, 'P'},
+		{"topology-log", required_argument, nullptr, 'o'},
+		{"keyframe-interval", required_argument, nullptr, 'k'},
+		{"load-topology", required_argument, nullptr, 'L'},
+		{"save-topology", required_argument, nullptr, 'S'},
+		{"converge", required_argument, nullptr, 'c'},
+		{"converge-window", required_argument, nullptr, 'W'},
+		{"baseline-cache", required_argument, nullptr, 'b'},
+		{"layout", required_argument, nullptr, 'y'},
+		{"live-stats", required_argument, nullptr, 'a'},
+		{"resilience", required_argument, nullptr, 'r'},
+		{"eclipse", required_argument, nullptr, 'E'},
+		{"spectrum", no_argument, nullptr, 'e'},
+		{"stats-shm", required_argument, nullptr, 'x'},
+		{"crawl", required_argument, nullptr, 'C'},
+		{"branch", required_argument, nullptr, 'B'},
+		{"variant", required_argument, nullptr, 'V'},
+		{"addr-coverage", required_argument, nullptr, 'A'},
+		{nullptr, 0, nullptr, 0}
+	};
+	int opt;
+	while((opt = getopt_long(argc, argv, "", longOptions, nullptr)) != -1) {
+		switch(opt) {
+			case 's':
+				options.shards = std::stoi(optarg);
+				break;
+			case 'w':
+				options.shardWindow = std::stoi(optarg);
+				break;
+			case 'd':
+				options.distanceSpillPath = optarg;
+				break;
+			case 'D':
+				options.distanceHistogram = false;
+				break;
+			case 'm':
+				if(!parseMetrics(optarg, options.metrics)) usage = true;
+				break;
+			case 't': {
+				//! \constraint stoul wraps a negative count around instead of failing, so the sign is checked as well
+				unsigned long threads = std::stoul(optarg);
+				if(optarg[0] == '-' || threads > MAXTHREADS) usage = true;
+				else options.threads = threads;
+				break;
+			}
+			case 'p':
+				options.propagationSources = std::stoul(optarg);
+				break;
+			case 'l': {
+				std::string latency(optarg);
+				size_t colon = latency.find(':');
+				options.minLatency = std::stoul(latency.substr(0, colon));
+				options.maxLatency = colon == std::string::npos ? options.minLatency : std::stoul(latency.substr(colon + 1));
+				break;
+			}
+			case 'P':
+				options.propagationSeed = std::stoul(optarg);
+				options.fixedPropagationSeed = true;
+				break;
+			case 'o':
+				options.topologyLogPath = optarg;
+				break;
+			case 'k':
+				options.keyframeInterval = std::stoul(optarg);
+				break;
+			case 'L':
+				options.loadTopologyPath = optarg;
+				break;
+			case 'S':
+				options.saveTopologyPath = optarg;
+				break;
+			case 'c':
+				options.convergenceTolerance = std::stod(optarg);
+				break;
+			case 'W':
+				options.convergenceWindow = std::stoul(optarg);
+				break;
+			case 'b':
+				options.baselineCacheDir = optarg;
+				break;
+			case 'y':
+				options.layoutIterations = std::stoul(optarg);
+				break;
+			case 'a':
+				options.liveStatsInterval = std::stoul(optarg);
+				break;
+			case 'r':
+				options.resilienceRuns = std::stoul(optarg);
+				break;
+			case 'E':
+				options.eclipseTrials = std::stoul(optarg);
+				break;
+			case 'e':
+				options.spectrum = true;
+				break;
+			case 'x':
+				options.statsName = optarg;
+				break;
+			case 'C':
+				options.crawlPath = optarg;
+				break;
+			case 'B':
+				options.branchTime = std::stoul(optarg);
+				break;
+			case 'A': {
+				std::string coverage(optarg);
+				size_t colon = coverage.find(':');
+				options.coverageAddrs = std::stoul(coverage.substr(0, colon));
+				options.coverageSince = colon == std::string::npos ? 0 : std::stoul(coverage.substr(colon + 1));
+				break;
+			}
+			case 'V': {
+				BranchVariant variant;
+				if(!parseVariant(optarg, variant)) usage = true;
+				options.variants.push_back(variant);
+				break;
+			}
+			default:
+				usage = true;
+		}
+	}
+	if(options.shards < 1 || options.shardWindow < 1) usage = true;
+	if(options.minLatency < 1 || options.maxLatency < options.minLatency) usage = true;
+	//! \constraint the workers of a sharded simulation only see their own connections, so there is no topology log
+	if(options.keyframeInterval < 1 || (options.shards > 1 && !options.topologyLogPath.empty())) usage = true;
+	//! \constraint warm starts and saved topologies need the directions of the connections, which the workers don't send
+	if(options.shards > 1 && (!options.loadTopologyPath.empty() || !options.saveTopologyPath.empty())) usage = true;
+	//! \constraint the workers of a sharded simulation would have to agree on the convergence, so it's only detected without --shards
+	if(options.convergenceTolerance < 0 || (options.shards > 1 && options.convergenceTolerance > 0)) usage = true;
+	//! \constraint like the topology log, the live statistics need every connection of the topology
+	if(options.shards > 1 && options.liveStatsInterval > 0) usage = true;
+	//! \constraint the workers of a sharded simulation need the whole population from the start to agree on the indices
+	if(options.shards > 1 && !options.crawlPath.empty()) usage = true;
+	//! \constraint the branches can't share the workers of a sharded simulation, nor the files the run writes while it runs or at its end
+	if(!options.variants.empty() && (options.shards > 1 || !options.topologyLogPath.empty() || !options.saveTopologyPath.empty())) usage = true;
+	//! \constraint the variants fork a warmed-up network, so they need a --branch tick after the start and before the end of the run
+	if(!options.variants.empty() || options.branchTime > 0) {
+		unsigned long duration = argc - optind >= 3 ? std::stoul(argv[optind + 2]) : simDuration;
+		if(options.variants.empty() || options.branchTime == 0 || options.branchTime >= duration) usage = true;
+	}
+	//! \constraint like the live statistics, the coverage needs the known nodes of the whole population, and a branching run only prints the table of its branches
+	if(options.coverageAddrs > MAXWATCHEDADDRS || (options.coverageAddrs > 0 && (options.shards > 1 || !options.variants.empty()))) usage = true;
+	//! \constraint the address tables of the other shards aren't available to the eclipse attack, and a branching run doesn't analyse its topology
+	if(options.eclipseTrials > 0 && (options.shards > 1 || !options.variants.empty())) usage = true;
+
 	// check arguments
-	switch(argc) {
+	char** args = argv + optind - 1;
+	switch(usage ? 0 : argc - optind + 1) {
 		case 6: 
-			graphFilePath = argv[5];
+			graphFilePath = args[5];
 		case 5: 
-			churn = std::stoi(argv[4]);
+			churn = std::stoi(args[4]);
 		case 4: 
-			simDuration = std::stoi(argv[3]);
+			simDuration = std::stoi(args[3]);
 		case 3: 
-			numberOfClientNodes = std::stoi(argv[2]);
+			numberOfClientNodes = std::stoi(args[2]);
 		case 2: 
-			numberOfServerNodes = std::stoi(argv[1]);
+			numberOfServerNodes = std::stoi(args[1]);
 			break;
 		case 1:
 		default:
-			std::cout << "usage: " << argv[0] << " number_of_server_nodes [number_of_client_nodes] [duration_of_simulation] [churn rate in node change per 10 sec.] [graphviz graph file path]" << std::endl;
+			std::cout << "usage: " << argv[0] << " [options] number_of_server_nodes [number_of_client_nodes] [duration_of_simulation] [churn rate in node change per 10 sec.] [graphviz graph file path]" << std::endl;
 			std::cout << "the duration should be provided in 1/10 seconds, default is 864000 (one day)" << std::endl;
+			std::cout << "options:" << std::endl;
+			std::cout << "  --shards N            split the nodes across N worker processes" << std::endl;
+			std::cout << "  --shard-window TICKS  ticks between two exchanges of cross-shard traffic, default is 10" << std::endl;
+			std::cout << "  --distance-spill PATH write the hop distance distribution of every vertex to PATH (and PATH.random)" << std::endl;
+			std::cout << "  --no-distances        skip the hop distance distribution (one traversal per vertex), the diameter stays exact" << std::endl;
+			std::cout << "  --metrics LIST        comma separated structure metrics to calculate: betweenness, kcore, degree, assortativity, components or all" << std::endl;
+			std::cout << "  --threads N           number of analysis threads (at most 1024), default is one per hardware thread" << std::endl;
+			std::cout << "  --propagation N       flood a message from N random origins over both graphs and print the propagation times" << std::endl;
+			std::cout << "  --latency MIN[:MAX]   per-hop latency of the propagation in ms, every edge draws a fixed one in [MIN, MAX], default is 100" << std::endl;
+			std::cout << "  --propagation-seed SEED  pick the propagation origins with SEED, default is a new seed every run" << std::endl;
+			std::cout << "  --topology-log PATH   log every edge added to or removed from the topology to PATH, not with --shards" << std::endl;
+			std::cout << "  --keyframe-interval TICKS  ticks between two full topologies in the topology log, default is 36000 (one hour)" << std::endl;
+			std::cout << "  --load-topology PATH  continue from a topology saved with --save-topology, its nodes are added to the given ones, not with --shards" << std::endl;
+			std::cout << "  --save-topology PATH  save the final topology to PATH, not with --shards" << std::endl;
+			std::cout << "  --converge TOLERANCE  end the run once churn rate, degree drift and clustering change stay below TOLERANCE, not with --shards" << std::endl;
+			std::cout << "  --converge-window TICKS  ticks the signals have to stay below the tolerance, default is 18000 (30 minutes)" << std::endl;
+			std::cout << "  --baseline-cache DIR  reuse the results of the random graph from DIR and store new ones there" << std::endl;
+			std::cout << "  --layout ITERATIONS   lay the written graphs out in-process and add the coordinates, draw them with neato -n" << std::endl;
+			std::cout << "  --live-stats TICKS    follow triangles, clustering and degrees edge by edge and print them every TICKS, not with --shards" << std::endl;
+			std::cout << "  --resilience RUNS     remove the nodes at random (averaged over RUNS orders), by degree and servers first and print the giant component" << std::endl;
+			std::cout << "  --eclipse TRIALS      estimate the probability that an attacker owning a fraction of the servers gets all outbound" << std::endl;
+			std::cout << "                        connections of a restarting node from TRIALS trials per fraction, not with --shards or --variant" << std::endl;
+			std::cout << "  --spectrum            print the algebraic connectivity and the spectral gap of the largest component" << std::endl;
+			std::cout << "  --stats-shm NAME      publish live statistics in the shared memory NAME every simulated second, read them with bittopsimstat" << std::endl;
+			std::cout << "  --crawl PATH          add the nodes of a real crawl as they show up and take them offline as their sessions end," << std::endl;
+			std::cout << "                        written by bittopsimcrawl" << std::endl;
+			std::cout << "  --addr-coverage N[:TICK]  follow the addresses of the first N (at most 255) servers starting from TICK through the" << std::endl;
+			std::cout << "                        known nodes and print their coverage over time, not with --shards or --variant" << std::endl;
+			std::cout << "  --branch TICK         fork the run into the --variant processes at TICK (after 0, before the end of the run)" << std::endl;
+			std::cout << "                        and compare their final topologies" << std::endl;
+			std::cout << "  --variant SPEC        a variant of the branch, changes like churn=N,outbound=N,attack=FRACTION or base," << std::endl;
+			std::cout << "                        repeat it for every variant, needs --branch, not with --shards, --topology-log or --save-topology" << std::endl;
 			return 0;
 			break;
 	}
 	// seed random number generator
 	srand(time(NULL));
-	Simulation sim(numberOfServerNodes, numberOfClientNodes, simDuration, graphFilePath, churn);
+	Simulation sim(numberOfServerNodes, numberOfClientNodes, simDuration, graphFilePath, churn, options);
 	return 0;
 }
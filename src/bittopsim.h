@@ -8,10 +8,65 @@
 #define BITTOPSIM_H
 
 #include "node.h"
+#include "message.h"
+#include "shard.h"
+#include "distance.h"
+#include "metrics.h"
+#include "propagation.h"
+#include "topologylog.h"
+#include "convergence.h"
+#include "baseline.h"
+#include "layout.h"
+#include "livestats.h"
+#include "resilience.h"
+#include "eclipse.h"
+#include "spectral.h"
+#include "statsexport.h"
+#include "taskgraph.h"
+#include "crawl.h"
+#include "branch.h"
+#include "coverage.h"
+#include "constants.h"
 #include <ctime>
 #include <memory>
 #include <unordered_map>
 
+/*!
+ * \brief The optional settings of a simulation run.
+ */
+typedef struct SimulationOptions {
+	unsigned int shards = 1; //!< number of worker processes the population is split across.
+	unsigned long shardWindow = 10; //!< ticks between two exchanges of cross-shard traffic.
+	bool distanceHistogram = true; //!< calculate the hop distance distribution, it takes one traversal per vertex.
+	std::string distanceSpillPath; //!< file the hop distances of every vertex are written to, if not empty.
+	unsigned int metrics = 0; //!< bit mask of the structure metrics to calculate, see Metric.
+	unsigned int threads = 0; //!< number of analysis threads, 0 uses one per hardware thread.
+	unsigned long propagationSources = 0; //!< number of origins flooding a message over the final topology, 0 disables it.
+	uint32_t minLatency = 100; //!< the smallest per-hop latency of the propagation in ms.
+	uint32_t maxLatency = 100; //!< the largest per-hop latency of the propagation in ms.
+	bool fixedPropagationSeed = false; //!< was the seed of the propagation origins given? Otherwise it's drawn after the run.
+	unsigned long propagationSeed = 0; //!< the seed the propagation origins are picked with.
+	std::string topologyLogPath; //!< file the changes of the topology are logged to, if not empty.
+	unsigned long keyframeInterval = 36000; //!< minimal ticks between two keyframes of the topology log.
+	std::string loadTopologyPath; //!< topology file the simulation continues from, if not empty.
+	std::string saveTopologyPath; //!< file the final topology is saved to, if not empty.
+	double convergenceTolerance = 0; //!< the run ends once the convergence signals stay below this tolerance, 0 disables it.
+	unsigned long convergenceWindow = 18000; //!< ticks the convergence signals have to stay below the tolerance.
+	std::string baselineCacheDir; //!< directory the results of the random graphs are cached in, if not empty.
+	unsigned int layoutIterations = 0; //!< iterations of the force-directed layout written with the graphs, 0 leaves the layout to graphviz.
+	unsigned long liveStatsInterval = 0; //!< ticks between two prints of the live triangle and degree statistics, 0 disables them.
+	unsigned long resilienceRuns = 0; //!< number of random removal orders of the resilience analysis, 0 disables it.
+	unsigned long eclipseTrials = 0; //!< number of eclipse attack trials per attacker fraction, 0 disables it.
+	bool spectrum = false; //!< calculate the algebraic connectivity and the spectral gap of the largest component.
+	std::string statsName; //!< shared-memory segment the live statistics are published in, if not empty.
+	std::string crawlPath; //!< crawl file whose sessions add nodes to the population and take them offline, if not empty.
+	unsigned int maxOutbound = MAXOUTBOUNDPEERS; //!< the outbound connections a node makes, the variants of a branch can change it.
+	unsigned long branchTime = 0; //!< the tick the run forks into its variants.
+	std::vector<BranchVariant> variants; //!< the variants the run forks into, it doesn't branch if there are none.
+	unsigned int coverageAddrs = 0; //!< the number of new servers whose addresses are followed through the known nodes, 0 disables it.
+	unsigned long coverageSince = 0; //!< the first tick a new server is watched at.
+} SimulationOptions;
+
 /*!
  * \brief Represents a simulation of the Bitcoin network's topology.
  */
@@ -24,14 +79,16 @@ class Simulation
 		 * \param numberOfServerNodes: number of server nodes that should be spawned.
 		 * \param endSimulationTime: the time the simulation should stop.
 		 * \param graphFilePath: the file path the graphviz graph will be written to.
+		 * \param churn: the maximum number of nodes leaving and joining per 10 seconds.
+		 * \param options: the optional settings of this run.
 		 */
-		Simulation(unsigned int numberOfServerNodes, unsigned int numberOfClientNodes, unsigned long endSimulationTime, std::string graphFilePath, int churn);
+		Simulation(unsigned int numberOfServerNodes, unsigned int numberOfClientNodes, unsigned long endSimulationTime, std::string graphFilePath, int churn, const SimulationOptions& options);
 		~Simulation();
 
 		/*!
 		 * bootstrap this Node with the hardcoded dnsseeds
 		 */
-		void bootstrapNode(Node::ptr node);
+		void bootstrapNode(const Node::ptr& node);
 
 		/*!
 		 * \brief return the current time of the simulation
@@ -48,53 +105,310 @@ class Simulation
 		/*!
 		 * \brief returns the dns seeder
 		 */
-		DNSSeeder::ptr getDNSSeeder();
+		const DNSSeeder::ptr& getDNSSeeder();
+
+		/*!
+		 * \brief returns the message bus
+		 */
+		const MessageBus::ptr& getMessageBus();
+
+		/*!
+		 * \brief returns the scratch memory of the current tick, it is reset after every tick
+		 */
+		const ScratchArena::ptr& getScratchArena();
 
 		/*!
 		 * \brief returns the list of nodes spawned
 		 */
-		Node::vector getAllNodes();
+		const Node::vector& getAllNodes();
+
+		/*!
+		 * \brief returns a node of the population
+		 * \param index is the index of the node
+		 */
+		const Node::ptr& getNode(unsigned long index);
+
+		/*!
+		 * \brief returns if a Node is simulated by this process
+		 */
+		bool isLocalNode(const Node::ptr& node);
+
+		/*!
+		 * \brief returns the shard context, nullptr if the simulation isn't sharded
+		 */
+		const ShardContext::ptr& getShardContext();
+
+		/*!
+		 * \brief returns the number of outbound connections a node makes
+		 */
+		unsigned int getMaxOutbound() const;
 
 		/*!
 		 * \brief set the online status of a Node
 		 * \param node is the node to be set online
 		 */
-		void setNodeOnline(Node::ptr node);
+		void setNodeOnline(const Node::ptr& node);
 
 		/*!
 		 * \brief set the offline status of a Node
 		 * \param node is the node to be set offline
 		 */
-		void setNodeOffline(Node::ptr node);
+		void setNodeOffline(const Node::ptr& node);
 
-		Node::vector getOnlineNodes();
+		/*!
+		 * \brief returns the online nodes, only valid until a node goes on- or offline
+		 */
+		const Node::vector& getOnlineNodes();
+
+		/*!
+		 * \brief run the maintenance of a Node next tick
+		 * \param node is the node with pending work
+		 */
+		void scheduleMaintenance(const Node::ptr& node);
+
+		/*!
+		 * \brief wake up a Node at a later time
+		 * \param node is the node to wake up
+		 * \param time is the simulation time the node will be woken up
+		 */
+		void scheduleWakeUp(const Node::ptr& node, unsigned long time);
+
+		/*!
+		 * \brief records that a Node opened a connection, for the topology log
+		 * \param node is the Node which holds the connection
+		 * \param peer is the Node it is connected to
+		 */
+		void connectionOpened(const Node::ptr& node, const Node::ptr& peer);
+
+		/*!
+		 * \brief records that a Node closed a connection, for the topology log
+		 * \param node is the Node which held the connection
+		 * \param peer is the Node it was connected to
+		 */
+		void connectionClosed(const Node::ptr& node, const Node::ptr& peer);
+
+		/*!
+		 * \brief records that a Node learned an address, for the address coverage
+		 * \param knower is the Node which added the address to its known nodes
+		 * \param known is the Node whose address it is
+		 */
+		void knownNodeAdded(const Node& knower, const Node& known);
+
+		/*!
+		 * \brief records that a Node forgot an address, for the address coverage
+		 * \param knower is the Node which removed the address from its known nodes
+		 * \param known is the Node whose address it is
+		 */
+		void knownNodeRemoved(const Node& knower, const Node& known);
 	private:
 
-		/*! \brief calculate and print the data analysis */
-		void calculateAndPrintData(Graph& g, Graph& randomGraph);
+		/*!
+		 * \brief adds a node to the population
+		 * \param node is the node to add
+		 * \param bootTime is the time the node will be started
+		 */
+		void addNode(const Node::ptr& node, unsigned long bootTime);
 
-		/*! \brief write the graphs to a graphviz file */
-		void writeGraphs(Graph& g, Graph& randomGraph, std::string graphFilePath);
+		/*!
+		 * \brief gives a node the next index of the population
+		 * \param node is the node to add
+		 */
+		void registerNode(const Node::ptr& node);
+
+		/*!
+		 * \brief opens the crawl file, its nodes are added to the population while the simulation runs
+		 * \param path is the crawl file
+		 * \return false if the file couldn't be read
+		 */
+		bool openCrawl(std::string path);
+
+		/*!
+		 * \brief starts the sessions of the crawl which begin this tick, creating the nodes which show up for the first time, and stops the ones which end
+		 */
+		void ingestCrawl();
+
+		/*!
+		 * \brief adds the nodes of a saved topology to the population, the online ones are started warm
+		 * \param path is the topology file
+		 * \param restored will hold the outbound connections to restore as (origin, destination) indices
+		 * \return false if the file couldn't be read
+		 */
+		bool loadTopology(std::string path, std::vector<std::pair<unsigned long, unsigned long>>& restored);
+
+		/*!
+		 * \brief restores the connections of a loaded topology and seeds the knownNodes of its nodes
+		 * \param restored are the outbound connections as (origin, destination) indices
+		 */
+		void restoreTopology(std::vector<std::pair<unsigned long, unsigned long>>& restored);
+
+		/*!
+		 * \brief saves the population and its outbound connections, so a later run can continue from it
+		 * \param path is the topology file
+		 * \return false if the file couldn't be written
+		 */
+		bool saveTopology(std::string path);
+
+		/*!
+		 * \brief runs the main simulation loop
+		 * \param endTime is the time the simulation should stop
+		 * \param churn is the maximum number of nodes leaving and joining per 10 seconds
+		 */
+		void run(unsigned long endTime, int churn);
+
+		/*!
+		 * \brief samples the convergence signals of the topology
+		 * \return true if the topology converged, so the run can end
+		 */
+		bool checkConvergence();
+
+		/*!
+		 * \brief prints the live triangle and degree statistics of the topology
+		 */
+		void printLiveStats();
+
+		/*!
+		 * \brief prints the coverage of the watched addresses over their age and the time they took to reach most nodes
+		 */
+		void printAddrCoverage();
+
+		/*!
+		 * \brief opens the shared-memory segment of the live statistics
+		 * \param name is the name of the segment.
+		 * \param shard is the worker of a sharded simulation, 0 without --shards.
+		 */
+		void openStatsExport(std::string name, unsigned int shard);
+
+		/*!
+		 * \brief publishes the live statistics in shared memory
+		 * \param endTime is the tick the run ends at.
+		 * \param finished marks the final values of the run.
+		 */
+		void publishStats(unsigned long endTime, bool finished);
+
+		/*!
+		 * \brief forks one process per variant, which continues the run with it and the same random numbers as the others
+		 * \param churn is the churn rate of the run, the variant of a branch can change it
+		 * \return true in the parent, which only waits for the results of the branches
+		 */
+		bool branch(int& churn);
+
+		/*!
+		 * \brief applies the changes of a variant to the simulation of a branch
+		 * \param variant is the variant of the branch
+		 * \param churn is the churn rate of the run
+		 */
+		void applyVariant(const BranchVariant& variant, int& churn);
+
+		/*!
+		 * \brief in a branch: writes the summary of its topology and exits, in the parent: waits for the branches and prints the comparison
+		 */
+		void finishBranch();
+
+		/*!
+		 * \brief summarizes the topology of a branch
+		 * \param result will hold the summary
+		 */
+		void summarizeBranch(BranchResult& result);
+
+		/*!
+		 * \brief runs the simulation in worker processes and merges their topology
+		 * \param endTime is the time the simulation should stop
+		 * \param churn is the maximum number of nodes leaving and joining per 10 seconds
+		 * \param g is the graph the merged topology is written to
+		 */
+		void runShards(unsigned long endTime, int churn, Graph& g);
+
+		/*!
+		 * \brief removes a node from the online or offline list in constant time
+		 */
+		void removeFromList(const Node::ptr& node, Node::vector& list, std::vector<unsigned long>& slots);
+
+		/*! \brief generate the random graph with the given vertex and edge count */
+		void generateRandomGraph(unsigned long vertices, unsigned long edges, Graph& randomGraph);
+
+		/*!
+		 * \brief builds the graph of the topology, analyses it next to the random graph, prints the results and writes both graphs
+		 *
+		 * The steps run as a TaskGraph on --threads threads: the random graph is generated while the topology is
+		 * converted, the analyses of both graphs run side by side and the graphviz files are written meanwhile.
+		 * The analyses of the random graph are taken from the baseline cache as far as possible.
+		 * \param g is the graph of the topology.
+		 * \param build tells if g has to be built from the online nodes, it is already merged in a sharded simulation.
+		 * \param graphFilePath is the file the graphs are written to, nothing is written if it is empty.
+		 */
+		void analyse(Graph& g, bool build, std::string graphFilePath);
+
+		/*! \brief print the analyses of the topology next to those of the random graph */
+		void printData(BaselineResults& results, ResilienceCurve& serverRemoval, BaselineResults& baseline);
+
+		/*! \brief write a graph to a graphviz file */
+		void writeGraph(std::string path, Graph& g);
+
+		/*! \brief write a graph in graphviz syntax, with the coordinates of the layout if it is enabled */
+		void writeGraph(std::ostream& file, Graph& g);
 
 		/*! \brief calculates the clustering coefficient of a graph */
 		float calculateClustering(Graph& g);
 
-		/*! \brief calculate all distances between vertices of a graph */
-		DistanceMatrix calculateDistances(Graph& g);
+		/*! \brief calculate the hop distance distribution of a graph, spilled per vertex to spillPath if it isn't empty */
+		DistanceHistogram calculateDistances(const CSRGraph& g, std::string spillPath);
+
+		/*! \brief print the mean geodesic path, the percentiles and the hop distance distributions */
+		void printDistances(DistanceHistogram& distances, DistanceHistogram& randomDistances);
+
+		/*! \brief print the results of the selected structure metrics */
+		void printMetrics(GraphMetrics& metrics, GraphMetrics& randomMetrics);
+
+		/*! \brief the settings the propagation is simulated with, the key of its cached results */
+		std::string propagationKey();
+
+		/*! \brief flood messages over the graph from the origins of the run */
+		PropagationStats calculatePropagation(const CSRGraph& g);
+
+		/*! \brief print the propagation times next to those of the random graph */
+		void printPropagation(PropagationStats& stats, PropagationStats& randomStats);
+
+		/*! \brief print the giant component under the three removal orders next to that of the random graph */
+		void printResilience(BaselineResults& results, ResilienceCurve& serverRemoval, BaselineResults& baseline);
 
-		/*! \brief calculate the mean geodesic path of a graph */
-		float calculateMeanGeodesic(Graph& g, DistanceMatrix& distances);
+		/*! \brief print the eclipse probabilities next to those with random address tables */
+		void printEclipse(EclipseStats& stats, EclipseStats& randomStats);
 
-		/*! \brief calculate the diameter of a graph */
-		unsigned long calculateDiameter(Graph& g, DistanceMatrix& distances);
+		/*! \brief print the extremal eigenvalues next to those of the random graph */
+		void printSpectrum(SpectralStats& stats, SpectralStats& randomStats);
 
 
 		static unsigned long simClock; //!< the current time for the simulation
 		DNSSeeder::ptr seed; //!< the DNSSeeder
+		MessageBus::ptr bus; //!< the message bus which delivers the messages of a tick
+		ScratchArena::ptr arena; //!< the scratch memory of the temporaries of a tick
 		Node::vector allNodes; //!< all nodes spawned
 		Node::vector onlineNodes; //!< all online nodes
 		Node::vector offlineNodes; //!< all offline nodes
+		std::vector<unsigned long> onlineSlots; //!< the position of every node in onlineNodes, NOINDEX if it isn't there
+		std::vector<unsigned long> offlineSlots; //!< the position of every node in offlineNodes, NOINDEX if it isn't there
+		SimulationOptions options; //!< the optional settings of this run
+		ShardContext::ptr shard; //!< the shard context of a worker process, nullptr if the simulation isn't sharded
+		TopologyLog::ptr topologyLog; //!< the log of the topology changes, nullptr if it isn't written
+		ConvergenceMonitor::ptr convergence; //!< tracks the convergence signals, nullptr if the run goes to its end
+		LiveStats::ptr liveStats; //!< follows the triangles and degrees of the topology, nullptr if they aren't printed
+		AddrCoverage::ptr addrCoverage; //!< follows which nodes know the watched addresses, nullptr if they aren't watched
+		StatsExport::ptr statsExport; //!< publishes the live statistics, nullptr if they aren't
+		CrawlStream::ptr crawl; //!< the sessions of a real crawl, nullptr without --crawl
+		unsigned long crawlStart; //!< the tick the first session of the crawl begins at
+		unsigned long crawlOffset; //!< the index of the first node of the crawl in allNodes
+		std::vector<unsigned long> crawlSessionEnds; //!< the tick the current session of every node of the crawl ends at, OPENSESSION if it lasts to the end
+		std::unordered_map<unsigned long, Node::vector> crawlStops; //!< the times at which a session of the crawl ends.
+		BranchResults::ptr branchResults; //!< the results of the branches, nullptr if the run didn't branch
+		std::vector<pid_t> branchProcesses; //!< the processes of the branches, only in the parent
+		unsigned long branchIndex; //!< the variant of this branch, NOINDEX in the parent
+		unsigned long branchAddrMessages; //!< the "addr" messages sent before the branch
+		unsigned long connectionEnds; //!< the open connections of the simulated nodes, counted at both ends
 		std::unordered_map<unsigned long, Node::vector> bootSchedule; //!< the times at which a node should be bootstrapped.
+		unsigned long lastBootTime; //!< the time the last node is bootstrapped.
+		std::unordered_map<unsigned long, Node::vector> wakeUpSchedule; //!< the times at which a node's back-off timer expires.
+		Node::vector pendingMaintenance; //!< the nodes which have work to do next tick.
+		Node::vector maintenanceBatch; //!< the nodes running their maintenance this tick.
 };
 
 #endif //BITTOPSIM_H
@@ -0,0 +1,108 @@
+/*!
+ * \brief Converts a crawler dump to the crawl file bittopsim reads with --crawl
+ */
+
+#include "crawl.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*!
+ * \brief parses a line "address,reachable,first_seen,uptime" of the dump
+ * \param line is the line to parse.
+ * \param address will hold the address.
+ * \param record will hold the other fields, firstSeen is still absolute.
+ * \return false if the line isn't a record, e.g. a header
+ */
+static bool parseLine(const std::string& line, std::string& address, CrawlRecord& record)
+{
+	std::istringstream fields(line);
+	std::string reachable, firstSeen, uptime;
+	if(!std::getline(fields, address, ',') || !std::getline(fields, reachable, ',') || !std::getline(fields, firstSeen, ',')) return false;
+	std::getline(fields, uptime);
+	try {
+		record.flags = reachable == "1" || reachable == "true" ? CRAWLREACHABLE : 0;
+		record.firstSeen = std::stoul(firstSeen);
+		record.uptime = uptime.empty() ? 0 : std::stoul(uptime);
+	} catch(std::exception&) {
+		return false;
+	}
+	return !address.empty();
+}
+
+int main(int argc, char* argv[])
+{
+	if(argc != 3) {
+		std::cout << "usage: " << argv[0] << " dump.csv crawl_file" << std::endl;
+		std::cout << "converts a crawler dump to the crawl file of --crawl, one session per line:" << std::endl;
+		std::cout << "  address,reachable,first_seen,uptime" << std::endl;
+		std::cout << "reachable is 1 or true if the node accepted inbound connections, first_seen is a unix time" << std::endl;
+		std::cout << "and uptime the seconds the node stayed online, 0 or empty if it was still online at the end" << std::endl;
+		return 0;
+	}
+
+	std::ifstream dump(argv[1]);
+	if(!dump.is_open()) {
+		std::cerr << "Could not open " << argv[1] << "." << std::endl;
+		return 1;
+	}
+
+	// the records keep the number of their address until they are sorted
+	std::unordered_map<std::string, uint32_t> addresses;
+	std::vector<CrawlRecord> records;
+	std::string line, address;
+	unsigned long skipped = 0;
+	while(std::getline(dump, line)) {
+		CrawlRecord record;
+		if(line.empty() || line[0] == '#') continue;
+		if(!parseLine(line, address, record)) {
+			skipped++;
+			continue;
+		}
+		auto known = addresses.emplace(address, addresses.size());
+		record.node = known.first->second;
+		records.push_back(record);
+	}
+	if(records.empty()) {
+		std::cerr << "There are no records in " << argv[1] << "." << std::endl;
+		return 1;
+	}
+
+	// the simulation streams the records, so they are ordered by time and the nodes numbered as they show up
+	std::stable_sort(std::begin(records), std::end(records), [](const CrawlRecord& a, const CrawlRecord& b) { return a.firstSeen < b.firstSeen; });
+	uint32_t start = records.front().firstSeen;
+	std::vector<uint32_t> number(addresses.size(), UINT32_MAX);
+	uint32_t nodes = 0;
+	for(CrawlRecord& record : records) {
+		if(number[record.node] == UINT32_MAX) {
+			number[record.node] = nodes++;
+		}
+		record.node = number[record.node];
+		record.firstSeen -= start;
+	}
+
+	CrawlHeader header;
+	header.magic = CRAWLMAGIC;
+	header.version = CRAWLVERSION;
+	header.records = records.size();
+	header.nodes = nodes;
+	header.lastSeen = records.back().firstSeen;
+
+	std::ofstream file(argv[2], std::ios::binary);
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(CrawlRecord));
+	if(!file.good()) {
+		std::cerr << "Could not write " << argv[2] << "." << std::endl;
+		return 1;
+	}
+	std::cout << records.size() << " sessions of " << nodes << " nodes over " << header.lastSeen << " seconds";
+	if(skipped > 0) {
+		std::cout << ", skipped " << skipped << " lines which aren't records";
+	}
+	std::cout << "." << std::endl;
+	return 0;
+}
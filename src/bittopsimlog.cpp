@@ -0,0 +1,51 @@
+/*!
+ * \brief Prints the topology a simulation logged with --topology-log at any tick
+ */
+
+#include "topologylog.h"
+#include <iostream>
+#include <string>
+#include <vector>
+
+int main(int argc, char* argv[])
+{
+	if(argc != 2 && argc != 3) {
+		std::cout << "usage: " << argv[0] << " log_file [tick]" << std::endl;
+		std::cout << "without a tick it prints the size of the population and the ticks of the keyframes," << std::endl;
+		std::cout << "with one it prints the edges of the topology after all changes up to the tick, one \"a b\" per line" << std::endl;
+		return 0;
+	}
+
+	TopologyLogReader reader(argv[1]);
+	if(!reader.isOpen()) {
+		std::cerr << "Could not read the topology log " << argv[1] << "." << std::endl;
+		return 1;
+	}
+
+	if(argc == 2) {
+		std::cout << "nodes " << reader.getNumberOfNodes() << std::endl;
+		for(unsigned long time : reader.getKeyframeTimes()) {
+			std::cout << "keyframe " << time << std::endl;
+		}
+		return 0;
+	}
+
+	unsigned long time;
+	try {
+		time = std::stoul(argv[2]);
+	} catch(std::exception&) {
+		std::cerr << "Invalid tick " << argv[2] << "." << std::endl;
+		return 1;
+	}
+
+	std::vector<std::pair<uint32_t, uint32_t>> edges;
+	if(!reader.topologyAt(time, edges)) {
+		std::cerr << "Could not rebuild the topology at tick " << time << "." << std::endl;
+		return 1;
+	}
+	std::cout << "# " << edges.size() << " edges between " << reader.getNumberOfNodes() << " nodes at tick " << time << std::endl;
+	for(const std::pair<uint32_t, uint32_t>& edge : edges) {
+		std::cout << edge.first << " " << edge.second << std::endl;
+	}
+	return 0;
+}
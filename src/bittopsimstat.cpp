@@ -0,0 +1,142 @@
+/*!
+ * \brief Reads the live statistics a simulation publishes with --stats-shm
+ */
+
+#include "statsexport.h"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <fcntl.h>
+#include <getopt.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+/*!
+ * \brief maps a segment read-only
+ * \param name is the name of the segment, a leading '/' is added if it is missing.
+ * \return the block or nullptr, if the segment doesn't exist or isn't a block of this version
+ */
+static const StatsBlock* openBlock(std::string name)
+{
+	if(name.empty() || name[0] != '/') name = "/" + name;
+	int fd = shm_open(name.c_str(), O_RDONLY, 0);
+	if(fd < 0) return nullptr;
+	void* memory = mmap(nullptr, sizeof(StatsBlock), PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if(memory == MAP_FAILED) return nullptr;
+
+	const StatsBlock* block = static_cast<const StatsBlock*>(memory);
+	if(block->magic != STATSMAGIC || block->version != STATSVERSION) {
+		munmap(memory, sizeof(StatsBlock));
+		return nullptr;
+	}
+	return block;
+}
+
+/*!
+ * \brief prints all values of a block as "key value" lines, for scraping
+ */
+static void printBlock(const std::string& name, const StatsBlock& stats)
+{
+	std::cout << "segment " << name << std::endl;
+	std::cout << "pid " << stats.pid << std::endl;
+	std::cout << "shard " << stats.shard << std::endl;
+	std::cout << "shards " << stats.shards << std::endl;
+	std::cout << "sim_clock " << stats.simClock << std::endl;
+	std::cout << "end_time " << stats.endTime << std::endl;
+	std::cout << "ticks_per_second " << stats.ticksPerSecond << std::endl;
+	std::cout << "online_nodes " << stats.onlineNodes << std::endl;
+	std::cout << "offline_nodes " << stats.offlineNodes << std::endl;
+	std::cout << "connection_ends " << stats.connectionEnds << std::endl;
+	std::cout << "version_messages " << stats.versionMessages << std::endl;
+	std::cout << "getaddr_messages " << stats.getaddrMessages << std::endl;
+	std::cout << "addr_messages " << stats.addrMessages << std::endl;
+	std::cout << "addr_entries " << stats.addrEntries << std::endl;
+	std::cout << "resident_bytes " << stats.residentBytes << std::endl;
+	std::cout << "finished " << stats.finished << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+	unsigned long watch = 0;
+	bool usage = false;
+	static struct option longOptions[] = {
+		{"watch", required_argument, nullptr, 'w'},
+		{nullptr, 0, nullptr, 0}
+	};
+	int opt;
+	while((opt = getopt_long(argc, argv, "", longOptions, nullptr)) != -1) {
+		switch(opt) {
+			case 'w':
+				watch = std::stoul(optarg);
+				break;
+			default:
+				usage = true;
+		}
+	}
+	if(usage || optind == argc) {
+		std::cout << "usage: " << argv[0] << " [--watch SECONDS] segment..." << std::endl;
+		std::cout << "prints the statistics a simulation publishes with --stats-shm, the segments of the workers of" << std::endl;
+		std::cout << "a sharded simulation are NAME-0 to NAME-(N-1)" << std::endl;
+		std::cout << "options:" << std::endl;
+		std::cout << "  --watch SECONDS  print a summary of all segments every SECONDS until the run is over" << std::endl;
+		return 0;
+	}
+
+	std::vector<std::string> names(argv + optind, argv + argc);
+	std::vector<const StatsBlock*> blocks;
+	for(const std::string& name : names) {
+		const StatsBlock* block = openBlock(name);
+		if(block == nullptr) {
+			std::cerr << "Could not open the statistics " << name << "." << std::endl;
+			return 1;
+		}
+		blocks.push_back(block);
+	}
+
+	if(watch == 0) {
+		for(unsigned int i = 0; i < blocks.size(); ++i) {
+			StatsBlock stats;
+			if(!readStatsBlock(blocks[i], stats)) {
+				std::cerr << "Could not read the statistics " << names[i] << "." << std::endl;
+				return 1;
+			}
+			printBlock(names[i], stats);
+		}
+		return 0;
+	}
+
+	// the workers of a sharded simulation are summed up, every worker sees all nodes and its own connections
+	std::cout << std::setw(12) << "Clock" << std::setw(8) << "Done" << std::setw(12) << "Ticks/s" << std::setw(10) << "Online" << std::setw(10) << "Offline" << std::setw(10) << "Edges" << std::setw(12) << "Messages" << std::setw(10) << "RSS MB" << std::endl;
+	for(bool finished = false; !finished; ) {
+		StatsBlock total;
+		std::memset(static_cast<void*>(&total), 0, sizeof(total));
+		finished = true;
+		double ticksPerSecond = 0;
+		for(unsigned int i = 0; i < blocks.size(); ++i) {
+			StatsBlock stats;
+			if(!readStatsBlock(blocks[i], stats)) continue;
+			// the slowest worker sets the pace
+			ticksPerSecond = i == 0 ? stats.ticksPerSecond : std::min(ticksPerSecond, stats.ticksPerSecond);
+			total.simClock = i == 0 ? stats.simClock : std::min(total.simClock, stats.simClock);
+			total.endTime = stats.endTime;
+			total.onlineNodes = stats.onlineNodes;
+			total.offlineNodes = stats.offlineNodes;
+			total.connectionEnds += stats.connectionEnds;
+			total.versionMessages += stats.versionMessages;
+			total.getaddrMessages += stats.getaddrMessages;
+			total.addrMessages += stats.addrMessages;
+			total.residentBytes += stats.residentBytes;
+			finished = finished && stats.finished;
+		}
+		double done = total.endTime == 0 ? 0 : 100.0 * total.simClock / total.endTime;
+		std::cout << std::setw(12) << total.simClock << std::setw(7) << std::fixed << std::setprecision(1) << done << "%" << std::setw(12) << std::setprecision(0) << ticksPerSecond << std::setw(10) << total.onlineNodes << std::setw(10) << total.offlineNodes << std::setw(10) << total.connectionEnds / 2 << std::setw(12) << total.versionMessages + total.getaddrMessages + total.addrMessages << std::setw(10) << total.residentBytes / (1 << 20) << std::endl;
+		if(!finished) {
+			sleep(watch);
+		}
+	}
+	return 0;
+}
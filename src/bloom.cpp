@@ -0,0 +1,64 @@
+#include "bloom.h"
+#include <algorithm>
+#include <cmath>
+
+RollingBloomFilter::RollingBloomFilter(unsigned int elements, double fpRate, uint32_t tweak) : entriesThisGeneration(0), generation(1), tweak(tweak)
+{
+	// the same sizing as Bitcoin, the filter holds three half generations of elements
+	double logFpRate = std::log(fpRate);
+	hashFunctions = std::max(1, std::min((int) std::round(logFpRate / std::log(0.5)), 50));
+	entriesPerGeneration = (elements + 1) / 2;
+	uint32_t maxElements = entriesPerGeneration * 3;
+	uint32_t filterBits = std::ceil(-1.0 * hashFunctions * maxElements / std::log(1.0 - std::exp(logFpRate / hashFunctions)));
+	data.assign(((filterBits + 63) / 64) << 1, 0);
+}
+
+uint32_t RollingBloomFilter::hash(unsigned int n, uint64_t key) const
+{
+	// the finalizer of MurmurHash3, seeded like Bitcoin's RollingBloomHash
+	uint64_t h = key ^ ((uint64_t) (n * 0xFBA4C795u + tweak) << 32);
+	h ^= h >> 33;
+	h *= 0xFF51AFD7ED558CCDull;
+	h ^= h >> 33;
+	h *= 0xC4CEB9FE1A85EC53ull;
+	h ^= h >> 33;
+	return h;
+}
+
+void RollingBloomFilter::insert(uint64_t key)
+{
+	if(entriesThisGeneration == entriesPerGeneration) {
+		entriesThisGeneration = 0;
+		generation = generation == 3 ? 1 : generation + 1;
+
+		// wipe the positions of the oldest generation, which had the same number
+		uint64_t mask1 = 0 - (uint64_t) (generation & 1);
+		uint64_t mask2 = 0 - (uint64_t) (generation >> 1);
+		for(size_t p = 0; p < data.size(); p += 2) {
+			uint64_t mask = (data[p] ^ mask1) | (data[p + 1] ^ mask2);
+			data[p] &= mask;
+			data[p + 1] &= mask;
+		}
+	}
+	entriesThisGeneration++;
+
+	for(unsigned int n = 0; n < hashFunctions; ++n) {
+		uint32_t h = hash(n, key);
+		unsigned int bit = h & 0x3F;
+		// the pair is picked by the upper bits, the bit by the lower ones
+		uint32_t pos = ((uint64_t) h * data.size()) >> 32;
+		data[pos & ~1u] = (data[pos & ~1u] & ~(1ull << bit)) | (uint64_t) (generation & 1) << bit;
+		data[pos | 1] = (data[pos | 1] & ~(1ull << bit)) | (uint64_t) (generation >> 1) << bit;
+	}
+}
+
+bool RollingBloomFilter::contains(uint64_t key) const
+{
+	for(unsigned int n = 0; n < hashFunctions; ++n) {
+		uint32_t h = hash(n, key);
+		unsigned int bit = h & 0x3F;
+		uint32_t pos = ((uint64_t) h * data.size()) >> 32;
+		if((((data[pos & ~1u] | data[pos | 1]) >> bit) & 1) == 0) return false;
+	}
+	return true;
+}
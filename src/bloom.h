@@ -0,0 +1,46 @@
+/*!
+ * \brief A bloom filter which forgets its oldest entries
+ */
+
+#ifndef BLOOM_H
+#define BLOOM_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/*!
+ * \brief Remembers about the last elements inserted, like Bitcoin's CRollingBloomFilter.
+ *
+ * The entries belong to one of three generations of elements / 2 entries. Every position of
+ * the filter holds the 2 bit generation of the last entry which set it, so once the third
+ * generation is full, the positions of the oldest generation are wiped at once. At least the
+ * last elements insertions are contained, false positives happen with about the given rate.
+ */
+class RollingBloomFilter
+{
+public:
+	typedef std::unique_ptr<RollingBloomFilter> ptr; //!< a unique_ptr of type RollingBloomFilter.
+
+	/*!
+	 * \param elements is the number of the most recent insertions which are always contained.
+	 * \param fpRate is the rate of false positives.
+	 * \param tweak varies the hash functions, so filters with the same elements have different false positives.
+	 */
+	RollingBloomFilter(unsigned int elements, double fpRate, uint32_t tweak);
+
+	void insert(uint64_t key); //!< inserts a key, which may wipe the oldest generation
+	bool contains(uint64_t key) const; //!< returns if the key was inserted recently, or is a false positive
+
+private:
+	uint32_t hash(unsigned int n, uint64_t key) const; //!< returns the n-th hash of a key
+
+	std::vector<uint64_t> data; //!< pairs of words, the same bit of both words is the generation of a position
+	unsigned int hashFunctions; //!< the number of positions of an entry
+	unsigned int entriesPerGeneration; //!< the number of insertions of a generation
+	unsigned int entriesThisGeneration; //!< the number of insertions of the current generation
+	unsigned int generation; //!< the current generation, 1 to 3, 0 is an empty position
+	uint32_t tweak; //!< varies the hash functions
+};
+
+#endif // BLOOM_H
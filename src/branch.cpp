@@ -0,0 +1,53 @@
+#include "branch.h"
+#include <sstream>
+#include <sys/mman.h>
+
+bool parseVariant(const std::string& spec, BranchVariant& variant)
+{
+	variant = BranchVariant();
+	variant.name = spec;
+	std::istringstream stream(spec);
+	std::string change;
+	while(std::getline(stream, change, ',')) {
+		if(change == "base") continue;
+		size_t equals = change.find('=');
+		if(equals == std::string::npos) return false;
+		std::string key = change.substr(0, equals);
+		std::string value = change.substr(equals + 1);
+		try {
+			if(key == "churn") variant.churn = std::stoi(value);
+			else if(key == "outbound") variant.maxOutbound = std::stoul(value);
+			else if(key == "attack") variant.attack = std::stod(value);
+			else return false;
+		} catch(std::exception&) {
+			return false;
+		}
+	}
+	return variant.churn >= -1 && variant.attack >= 0 && variant.attack <= 1;
+}
+
+BranchResults::BranchResults(unsigned int branches) : results(nullptr), branches(branches)
+{
+	void* memory = mmap(nullptr, branches * sizeof(BranchResult), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if(memory != MAP_FAILED) {
+		// the mapping is zeroed, so no branch is done yet
+		results = static_cast<BranchResult*>(memory);
+	}
+}
+
+BranchResults::~BranchResults()
+{
+	if(results != nullptr) {
+		munmap(results, branches * sizeof(BranchResult));
+	}
+}
+
+bool BranchResults::isOpen() const
+{
+	return results != nullptr;
+}
+
+BranchResult& BranchResults::at(unsigned int branch)
+{
+	return results[branch];
+}
@@ -0,0 +1,76 @@
+/*!
+ * \brief The variants a running simulation branches into and their results
+ */
+
+#ifndef BRANCH_H
+#define BRANCH_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+/*!
+ * \brief The changes a branch applies to the simulation it was forked from.
+ */
+typedef struct BranchVariant {
+	std::string name; //!< the specification the variant was parsed from
+	int churn = -1; //!< the churn rate of the branch, -1 keeps the one of the run
+	unsigned int maxOutbound = 0; //!< the outbound connections per node, 0 keeps the limit
+	double attack = 0; //!< the fraction of the online nodes with the highest degree taken offline at the branch
+} BranchVariant;
+
+/*!
+ * \brief parses a variant, a comma separated list of changes, e.g. "churn=50,outbound=4", "attack=0.05" or "base"
+ * \param spec is the specification to parse.
+ * \param variant will hold the changes.
+ * \return false if the specification contains an unknown or invalid change
+ */
+bool parseVariant(const std::string& spec, BranchVariant& variant);
+
+/*!
+ * \brief The summary of the final topology of a branch, written by the branch into shared memory.
+ */
+typedef struct BranchResult {
+	uint32_t done; //!< 1 once the branch wrote its results
+	uint64_t onlineNodes; //!< the online nodes
+	uint64_t edges; //!< the connections between them
+	double meanDegree; //!< the mean number of connections per node
+	float clustering; //!< the clustering coefficient
+	uint32_t diameter; //!< the diameter
+	double meanDistance; //!< the mean geodesic distance, 0 with --no-distances
+	uint32_t components; //!< the connected components
+	uint32_t largestComponent; //!< the nodes in the largest component
+	uint64_t addrMessages; //!< the "addr" messages sent after the branch
+} BranchResult;
+
+/*!
+ * \brief The results of all branches in an anonymous shared mapping.
+ *
+ * It is created before the branches are forked, so every branch writes to the same pages
+ * the parent reads, without pipes or serialization.
+ */
+class BranchResults
+{
+public:
+	typedef std::shared_ptr<BranchResults> ptr; //!< a shared_ptr of type BranchResults.
+
+	/*!
+	 * \param branches is the number of branches.
+	 */
+	BranchResults(unsigned int branches);
+	~BranchResults();
+
+	bool isOpen() const; //!< returns if the mapping could be created
+
+	/*!
+	 * \brief returns the results of a branch
+	 * \param branch is the index of the branch.
+	 */
+	BranchResult& at(unsigned int branch);
+
+private:
+	BranchResult* results; //!< the mapped results, nullptr if the mapping couldn't be created
+	unsigned int branches; //!< the number of branches
+};
+
+#endif // BRANCH_H
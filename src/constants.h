@@ -20,4 +20,79 @@ const unsigned int MAXCONNECTEDPEERS = 125;
  */
 const unsigned int MAXOUTBOUNDPEERS = 8;
 
+/*!
+ * The longest time (in ticks) a Node below its outbound target waits before it retries to connect
+ */
+const unsigned long MAXMAINTENANCEBACKOFF = 600;
+
+/*!
+ * The index of a Node which isn't part of the simulated population (e.g. a CrawlerNode)
+ */
+const unsigned long NOINDEX = -1;
+
+/*!
+ * The capacity (in 32 bit words) of a shared-memory ring between two shards
+ */
+const unsigned long SHARDRINGSIZE = 1 << 18;
+
+/*!
+ * The most analysis threads --threads accepts
+ */
+const unsigned long MAXTHREADS = 1024;
+
+/*!
+ * The size (in bytes) of a block of the scratch memory the temporaries of a tick are allocated from
+ */
+const unsigned long SCRATCHBLOCKSIZE = 1 << 16;
+
+/*!
+ * The number of the most recent addrs a Node remembers as known per connection
+ */
+const unsigned int ADDRKNOWNELEMENTS = 1000;
+
+/*!
+ * The false positive rate of the per connection filter of known addrs
+ */
+const double ADDRKNOWNFPRATE = 0.001;
+
+/*!
+ * The time (in ticks) between two samples of the coverage of the watched addrs, one simulated second
+ */
+const unsigned long ADDRCOVERAGEINTERVAL = 10;
+
+/*!
+ * The ticks of a second of a real crawl
+ */
+const unsigned long CRAWLTICKSPERSECOND = 10;
+
+/*!
+ * The end of a crawl session which lasts to the end of the crawl
+ */
+const unsigned long OPENSESSION = -1;
+
+/*!
+ * The time (in ticks) between two updates of the shared-memory statistics, one simulated second
+ */
+const unsigned long STATSEXPORTINTERVAL = 10;
+
+/*!
+ * The time (in ticks) between two samples of the convergence signals
+ */
+const unsigned long CONVERGENCESAMPLEINTERVAL = 600;
+
+/*!
+ * The number of online Nodes whose local clustering coefficient is sampled for the convergence detection
+ */
+const unsigned int CLUSTERINGSAMPLESIZE = 256;
+
+/*!
+ * The generator of the random graphs the topology is compared to, it names their entries in the baseline cache
+ */
+const char RANDOMGRAPHGENERATOR[] = "boost-gnm";
+
+/*!
+ * The seed of the random graph generator (the default seed of mt19937)
+ */
+const unsigned long RANDOMGRAPHSEED = 5489;
+
 #endif // CONSTANTS
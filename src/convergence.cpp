@@ -0,0 +1,108 @@
+#include "convergence.h"
+#include "constants.h"
+#include <cmath>
+#include <unordered_set>
+
+ConvergenceMonitor::ConvergenceMonitor(double tolerance, unsigned long window) : tolerance(tolerance), window(window), stableSince(NOTSTABLE), changes(0), first(true), clustering(0), churnRate(0), degreeDrift(0), clusteringChange(0) {}
+
+void ConvergenceMonitor::connectionChanged()
+{
+	changes++;
+}
+
+bool ConvergenceMonitor::sample(unsigned long time, Node::vector& onlineNodes)
+{
+	// the degree distribution, connections to the crawler are left out
+	std::vector<double> distribution;
+	unsigned long slots = 0;
+	for(const Node::ptr& n : onlineNodes) {
+		unsigned long degree = 0;
+		for(const Node::ptr& c : n->getConnections()) {
+			if(c->getIndex() != NOINDEX) degree++;
+		}
+		if(degree >= distribution.size()) {
+			distribution.resize(degree + 1, 0);
+		}
+		distribution[degree]++;
+		slots += degree;
+	}
+	for(double& count : distribution) {
+		count /= onlineNodes.empty() ? 1 : onlineNodes.size();
+	}
+
+	double sampledClustering = sampleClustering(onlineNodes);
+
+	churnRate = slots > 0 ? (double) changes / slots : (changes > 0 ? 1 : 0);
+	degreeDrift = 0;
+	for(unsigned long d = 0; d < std::max(distribution.size(), degrees.size()); ++d) {
+		double now = d < distribution.size() ? distribution[d] : 0;
+		double before = d < degrees.size() ? degrees[d] : 0;
+		degreeDrift += std::fabs(now - before) / 2;
+	}
+	clusteringChange = clustering > 0 ? std::fabs(sampledClustering - clustering) / clustering : sampledClustering;
+
+	bool stable = !first && churnRate <= tolerance && degreeDrift <= tolerance && clusteringChange <= tolerance;
+	degrees.swap(distribution);
+	clustering = sampledClustering;
+	changes = 0;
+	first = false;
+
+	if(!stable) {
+		stableSince = NOTSTABLE;
+		return false;
+	}
+	if(stableSince == NOTSTABLE) {
+		stableSince = time;
+	}
+	return time - stableSince >= window;
+}
+
+double ConvergenceMonitor::sampleClustering(Node::vector& onlineNodes)
+{
+	if(onlineNodes.empty()) return 0;
+
+	//! \constraint the same Nodes are sampled every time, so the noise of the sample doesn't look like a change of the topology
+	sampledNodes.resize(CLUSTERINGSAMPLESIZE);
+	for(Node::ptr& n : sampledNodes) {
+		if(n == nullptr || !n->isOnline()) {
+			n = randomNodeOfVector(onlineNodes);
+		}
+	}
+
+	double sum = 0;
+	std::unordered_set<unsigned long> neighbors;
+	for(const Node::ptr& n : sampledNodes) {
+		neighbors.clear();
+		const Node::vector& connections = n->getConnections();
+		for(const Node::ptr& c : connections) {
+			if(c->getIndex() != NOINDEX) neighbors.insert(c->getIndex());
+		}
+		if(neighbors.size() < 2) continue;
+
+		// every link between two neighbors is seen from both of them
+		unsigned long links = 0;
+		for(const Node::ptr& c : connections) {
+			if(c->getIndex() == NOINDEX) continue;
+			for(const Node::ptr& cc : c->getConnections()) {
+				if(cc->getIndex() != NOINDEX && neighbors.count(cc->getIndex()) > 0) links++;
+			}
+		}
+		sum += (double) links / (neighbors.size() * (neighbors.size() - 1));
+	}
+	return sum / CLUSTERINGSAMPLESIZE;
+}
+
+double ConvergenceMonitor::getChurnRate()
+{
+	return churnRate;
+}
+
+double ConvergenceMonitor::getDegreeDrift()
+{
+	return degreeDrift;
+}
+
+double ConvergenceMonitor::getClusteringChange()
+{
+	return clusteringChange;
+}
@@ -0,0 +1,68 @@
+/*!
+ * \brief Detects when the simulated topology stops changing
+ */
+
+#ifndef CONVERGENCE_H
+#define CONVERGENCE_H
+
+#include "node.h"
+#include <memory>
+#include <vector>
+
+static const unsigned long NOTSTABLE = -1; //!< the start of the stable samples while the last sample wasn't stable
+
+/*!
+ * \brief Tracks cheap convergence signals of the running simulation.
+ *
+ * Every sample compares three signals with the previous sample:
+ * - the churn rate: the connections opened or closed since, relative to all connections
+ * - the degree drift: the total variation distance between the degree distributions
+ * - the clustering change: the relative change of the mean local clustering coefficient of a fixed random sample of Nodes
+ *
+ * The topology counts as converged once all three stayed within the tolerance for the whole window.
+ */
+class ConvergenceMonitor
+{
+public:
+	typedef std::shared_ptr<ConvergenceMonitor> ptr; //!< a shared_ptr of type ConvergenceMonitor.
+
+	/*!
+	 * \param tolerance is the largest value of every signal which still counts as stable.
+	 * \param window is the time (in ticks) the signals have to stay stable.
+	 */
+	ConvergenceMonitor(double tolerance, unsigned long window);
+
+	/*!
+	 * \brief counts a connection which was opened or closed
+	 */
+	void connectionChanged();
+
+	/*!
+	 * \brief samples the signals
+	 * \param time is the current simulation time.
+	 * \param onlineNodes are the online Nodes of the simulation.
+	 * \return true if the topology converged
+	 */
+	bool sample(unsigned long time, Node::vector& onlineNodes);
+
+	double getChurnRate(); //!< returns the churn rate of the last sample
+	double getDegreeDrift(); //!< returns the degree drift of the last sample
+	double getClusteringChange(); //!< returns the clustering change of the last sample
+
+private:
+	double sampleClustering(Node::vector& onlineNodes); //!< the mean local clustering coefficient of the sampled Nodes
+
+	double tolerance; //!< the largest value of every signal which still counts as stable
+	unsigned long window; //!< the time the signals have to stay stable
+	unsigned long stableSince; //!< the time of the first stable sample in a row, NOTSTABLE if the last one wasn't stable
+	unsigned long changes; //!< connections opened or closed since the last sample
+	bool first; //!< is there no previous sample to compare with?
+	std::vector<double> degrees; //!< the degree distribution of the last sample
+	Node::vector sampledNodes; //!< the Nodes whose clustering is sampled, offline ones are replaced
+	double clustering; //!< the sampled clustering of the last sample
+	double churnRate; //!< the churn rate of the last sample
+	double degreeDrift; //!< the degree drift of the last sample
+	double clusteringChange; //!< the clustering change of the last sample
+};
+
+#endif // CONVERGENCE_H
@@ -0,0 +1,96 @@
+#include "coverage.h"
+#include <algorithm>
+
+AddrCoverage::AddrCoverage(unsigned int watched, unsigned long since, uint32_t numberOfNodes) : watched(std::min(watched, MAXWATCHEDADDRS)), since(since), slotOf(numberOfNodes, 0), online((numberOfNodes + 63) / 64, 0), seen(online.size(), 0)
+{
+	known.reserve(this->watched);
+	curves.reserve(this->watched);
+}
+
+void AddrCoverage::nodeOnline(uint32_t node, bool server, unsigned long clock)
+{
+	if(node >= slotOf.size()) return;
+	online[node / 64] |= 1ull << (node % 64);
+
+	//! \constraint only the first session of a server is watched, it starts with no node knowing the address
+	bool first = !((seen[node / 64] >> (node % 64)) & 1);
+	seen[node / 64] |= 1ull << (node % 64);
+	if(!server || !first || clock < since || curves.size() == watched) return;
+	slotOf[node] = curves.size() + 1;
+	known.emplace_back(online.size(), 0);
+	CoverageCurve curve;
+	curve.node = node;
+	curve.start = clock;
+	std::fill(std::begin(curve.coverage), std::end(curve.coverage), -1);
+	std::fill(std::begin(curve.reached), std::end(curve.reached), NOTREACHED);
+	curves.push_back(curve);
+	nextAge.push_back(0);
+}
+
+void AddrCoverage::nodeRestored(uint32_t node, bool online)
+{
+	if(node >= slotOf.size()) return;
+	if(online) {
+		this->online[node / 64] |= 1ull << (node % 64);
+	}
+	seen[node / 64] |= 1ull << (node % 64);
+}
+
+void AddrCoverage::nodeOffline(uint32_t node)
+{
+	if(node >= slotOf.size()) return;
+	online[node / 64] &= ~(1ull << (node % 64));
+}
+
+void AddrCoverage::learned(uint32_t knower, uint32_t known)
+{
+	if(known >= slotOf.size() || knower >= slotOf.size() || slotOf[known] == 0) return;
+	this->known[slotOf[known] - 1][knower / 64] |= 1ull << (knower % 64);
+}
+
+void AddrCoverage::forgot(uint32_t knower, uint32_t known)
+{
+	if(known >= slotOf.size() || knower >= slotOf.size() || slotOf[known] == 0) return;
+	this->known[slotOf[known] - 1][knower / 64] &= ~(1ull << (knower % 64));
+}
+
+void AddrCoverage::sample(unsigned long clock)
+{
+	if(curves.empty()) return;
+
+	// the online nodes are the same for every address
+	uint64_t onlineCount = 0;
+	for(uint64_t word : online) {
+		onlineCount += __builtin_popcountll(word);
+	}
+
+	for(unsigned int slot = 0; slot < curves.size(); ++slot) {
+		CoverageCurve& curve = curves[slot];
+		if(nextAge[slot] == COVERAGEAGES && curve.reached[COVERAGESHARES - 1] != NOTREACHED) continue;
+
+		uint64_t count = 0;
+		const std::vector<uint64_t>& knowers = known[slot];
+		for(size_t w = 0; w < online.size(); ++w) {
+			count += __builtin_popcountll(knowers[w] & online[w]);
+		}
+
+		// the server itself doesn't count, it can't know its own address
+		uint64_t others = onlineCount - ((online[curve.node / 64] >> (curve.node % 64)) & 1);
+		double coverage = others > 0 ? (double) count / others : 0;
+
+		unsigned long age = clock - curve.start;
+		while(nextAge[slot] < COVERAGEAGES && COVERAGEAGE[nextAge[slot]] <= age) {
+			curve.coverage[nextAge[slot]++] = coverage;
+		}
+		for(unsigned int s = 0; s < COVERAGESHARES; ++s) {
+			if(curve.reached[s] == NOTREACHED && coverage >= COVERAGESHARE[s]) {
+				curve.reached[s] = age;
+			}
+		}
+	}
+}
+
+const std::vector<CoverageCurve>& AddrCoverage::getCurves() const
+{
+	return curves;
+}
@@ -0,0 +1,111 @@
+/*!
+ * \brief How fast the addresses of new servers spread through the known nodes of the network
+ */
+
+#ifndef COVERAGE_H
+#define COVERAGE_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/*!
+ * \brief The ages (in ticks) of a watched address its coverage is reported for: 1s, 5s, 10s, 30s, 1m, 2m, 5m, 10m, 30m, 1h, 3h, 6h, 12h and 24h
+ */
+static const unsigned long COVERAGEAGE[] = {10, 50, 100, 300, 600, 1200, 3000, 6000, 18000, 36000, 108000, 216000, 432000, 864000};
+static const unsigned int COVERAGEAGES = sizeof(COVERAGEAGE) / sizeof(COVERAGEAGE[0]);
+
+/*!
+ * \brief The coverages the time to reach them is reported for
+ */
+static const double COVERAGESHARE[] = {0.5, 0.9, 0.99};
+static const unsigned int COVERAGESHARES = sizeof(COVERAGESHARE) / sizeof(COVERAGESHARE[0]);
+
+static const unsigned int MAXWATCHEDADDRS = 255; //!< the most addresses which can be watched at once
+
+static const unsigned long NOTREACHED = -1; //!< the age of a coverage which wasn't reached by the end of the run
+
+/*!
+ * \brief The spread of one watched address, its coverage is the share of the online nodes which know it.
+ */
+typedef struct CoverageCurve {
+	uint32_t node; //!< the index of the watched server
+	unsigned long start; //!< the tick the server came online
+	double coverage[COVERAGEAGES]; //!< the coverage at every age of COVERAGEAGE, -1 if the run ended before
+	unsigned long reached[COVERAGESHARES]; //!< the age (in ticks) the coverage reached every share of COVERAGESHARE, NOTREACHED if it didn't
+} CoverageCurve;
+
+/*!
+ * \brief Tracks which nodes know the addresses of the first servers which come online after a given tick.
+ *
+ * Every watched address has a bitset over the population, a bit is set while the node has the address
+ * in its known nodes. The online nodes are a bitset as well, so a coverage is a popcount of their
+ * intersection, 64 nodes per instruction, and an update only flips a bit.
+ */
+class AddrCoverage
+{
+public:
+	typedef std::shared_ptr<AddrCoverage> ptr; //!< a shared_ptr of type AddrCoverage.
+
+	/*!
+	 * \param watched is the number of addresses to watch, at most MAXWATCHEDADDRS.
+	 * \param since is the first tick a server which comes online is watched at.
+	 * \param numberOfNodes is the size of the node population.
+	 */
+	AddrCoverage(unsigned int watched, unsigned long since, uint32_t numberOfNodes);
+
+	/*!
+	 * \brief records that a node came online, a server may become watched
+	 * \param node is the index of the node.
+	 * \param server tells if the node accepts inbound connections.
+	 * \param clock is the current tick.
+	 */
+	void nodeOnline(uint32_t node, bool server, unsigned long clock);
+
+	/*!
+	 * \brief records a node of a loaded topology, it was online before the run and is never watched
+	 * \param node is the index of the node.
+	 * \param online tells if the node was warm started.
+	 */
+	void nodeRestored(uint32_t node, bool online);
+
+	/*!
+	 * \brief records that a node went offline
+	 * \param node is the index of the node.
+	 */
+	void nodeOffline(uint32_t node);
+
+	/*!
+	 * \brief records that a node added another one to its known nodes
+	 * \param knower is the index of the node which learned the address.
+	 * \param known is the index of the node whose address it learned.
+	 */
+	void learned(uint32_t knower, uint32_t known);
+
+	/*!
+	 * \brief records that a node removed another one from its known nodes
+	 * \param knower is the index of the node which forgot the address.
+	 * \param known is the index of the node whose address it forgot.
+	 */
+	void forgot(uint32_t knower, uint32_t known);
+
+	/*!
+	 * \brief measures the coverages of the watched addresses and updates their curves
+	 * \param clock is the current tick.
+	 */
+	void sample(unsigned long clock);
+
+	const std::vector<CoverageCurve>& getCurves() const; //!< returns the curves of the addresses watched so far
+
+private:
+	unsigned int watched; //!< the number of addresses to watch
+	unsigned long since; //!< the first tick a server is watched at
+	std::vector<uint8_t> slotOf; //!< the slot of every watched node plus one, 0 for the others
+	std::vector<std::vector<uint64_t>> known; //!< the nodes which know every watched address, a bitset per slot
+	std::vector<uint64_t> online; //!< the online nodes as a bitset
+	std::vector<uint64_t> seen; //!< the nodes which were online before as a bitset
+	std::vector<CoverageCurve> curves; //!< the curve of every slot
+	std::vector<unsigned int> nextAge; //!< the next age of COVERAGEAGE of every slot
+};
+
+#endif // COVERAGE_H
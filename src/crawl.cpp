@@ -0,0 +1,81 @@
+#include "crawl.h"
+#include <algorithm>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const size_t CRAWLRELEASEBYTES = 1 << 24; //!< the bytes read between two hand backs of the mapped pages
+
+CrawlStream::CrawlStream(std::string path) : memory(nullptr), size(0), header(nullptr), records(nullptr), position(0), released(0)
+{
+	int fd = open(path.c_str(), O_RDONLY);
+	if(fd < 0) return;
+	struct stat info;
+	if(fstat(fd, &info) != 0 || (size_t) info.st_size < sizeof(CrawlHeader)) {
+		close(fd);
+		return;
+	}
+	size = info.st_size;
+	void* mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if(mapping == MAP_FAILED) return;
+	memory = static_cast<const char*>(mapping);
+	madvise(mapping, size, MADV_SEQUENTIAL);
+
+	header = reinterpret_cast<const CrawlHeader*>(memory);
+	records = reinterpret_cast<const CrawlRecord*>(memory + sizeof(CrawlHeader));
+	if(header->magic != CRAWLMAGIC || header->version != CRAWLVERSION || (size - sizeof(CrawlHeader)) / sizeof(CrawlRecord) < header->records) {
+		munmap(mapping, size);
+		memory = nullptr;
+	}
+}
+
+CrawlStream::~CrawlStream()
+{
+	if(memory != nullptr) {
+		munmap(const_cast<char*>(memory), size);
+	}
+}
+
+bool CrawlStream::isOpen() const
+{
+	return memory != nullptr;
+}
+
+uint32_t CrawlStream::getNodes() const
+{
+	return header->nodes;
+}
+
+uint64_t CrawlStream::getRecords() const
+{
+	return header->records;
+}
+
+uint32_t CrawlStream::getLastSeen() const
+{
+	return header->lastSeen;
+}
+
+const CrawlRecord* CrawlStream::next(uint32_t until)
+{
+	if(position == header->records || records[position].firstSeen > until) return nullptr;
+	const CrawlRecord* record = &records[position++];
+	if((const char*) (records + position) - memory - released >= CRAWLRELEASEBYTES) {
+		release();
+	}
+	return record;
+}
+
+void CrawlStream::release()
+{
+	// only whole pages before the current record, the header stays for the getters
+	size_t page = sysconf(_SC_PAGESIZE);
+	size_t end = ((const char*) (records + position) - memory) / page * page;
+	size_t start = std::max(released, page);
+	if(end > start) {
+		madvise(const_cast<char*>(memory) + start, end - start, MADV_DONTNEED);
+	}
+	released = end;
+}
@@ -0,0 +1,81 @@
+/*!
+ * \brief Streams the sessions of a real network crawl from a memory-mapped file
+ */
+
+#ifndef CRAWL_H
+#define CRAWL_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+static const uint32_t CRAWLMAGIC = 0x4c575243; //!< "CRWL" in little endian, the start of every crawl file
+static const uint32_t CRAWLVERSION = 1; //!< the layout of CrawlHeader and CrawlRecord
+static const uint32_t CRAWLREACHABLE = 1 << 0; //!< the flag of a session in which the node accepted inbound connections
+
+/*!
+ * \brief The header of a crawl file, it is followed by the records.
+ */
+typedef struct CrawlHeader {
+	uint32_t magic; //!< CRAWLMAGIC
+	uint32_t version; //!< CRAWLVERSION
+	uint64_t records; //!< the number of records
+	uint32_t nodes; //!< the number of distinct addresses
+	uint32_t lastSeen; //!< the firstSeen of the last record
+} CrawlHeader;
+
+/*!
+ * \brief One session of a node: it was seen at firstSeen and stayed online for uptime seconds.
+ *
+ * The records are ordered by firstSeen. The nodes are numbered in the order they are first seen,
+ * so a record either refers to a node of an earlier record or to the next new one.
+ */
+typedef struct CrawlRecord {
+	uint32_t node; //!< the number of the address
+	uint32_t flags; //!< CRAWLREACHABLE if the node was reachable
+	uint32_t firstSeen; //!< the seconds since the first record
+	uint32_t uptime; //!< the seconds the node stayed online, 0 if it was still online at the end of the crawl
+} CrawlRecord;
+
+/*!
+ * \brief Reads the records of a crawl file in order without loading the file.
+ *
+ * The file is memory-mapped and read front to back, the pages which were read are handed
+ * back to the kernel every CRAWLRELEASEBYTES, so the resident memory stays small however
+ * long the crawl is.
+ */
+class CrawlStream
+{
+public:
+	typedef std::shared_ptr<CrawlStream> ptr; //!< a shared_ptr of type CrawlStream.
+
+	/*!
+	 * \param path is the crawl file, written by bittopsimcrawl.
+	 */
+	CrawlStream(std::string path);
+	~CrawlStream();
+
+	bool isOpen() const; //!< returns if the file could be mapped and has a valid header
+	uint32_t getNodes() const; //!< returns the number of distinct nodes of the crawl
+	uint64_t getRecords() const; //!< returns the number of records of the crawl
+	uint32_t getLastSeen() const; //!< returns the second the last node shows up
+
+	/*!
+	 * \brief takes the next record, if it was seen until the given time
+	 * \param until is the latest firstSeen to return, in seconds since the first record.
+	 * \return the record or nullptr, if the next record is seen later or all were read
+	 */
+	const CrawlRecord* next(uint32_t until);
+
+private:
+	void release(); //!< hands the pages which were read back to the kernel
+
+	const char* memory; //!< the mapped file, nullptr if it couldn't be mapped
+	size_t size; //!< the size of the mapping
+	const CrawlHeader* header; //!< the header of the file
+	const CrawlRecord* records; //!< the first record
+	uint64_t position; //!< the next record to return
+	size_t released; //!< the bytes at the start of the mapping which were handed back
+};
+
+#endif // CRAWL_H
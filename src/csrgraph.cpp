@@ -0,0 +1,18 @@
+#include "csrgraph.h"
+
+CSRGraph::CSRGraph(Graph& g) : offsets(boost::num_vertices(g) + 1, 0)
+{
+	uint32_t n = boost::num_vertices(g);
+	for(uint32_t v = 0; v < n; ++v) {
+		offsets[v + 1] = offsets[v] + boost::out_degree(v, g);
+	}
+
+	targets.resize(offsets[n]);
+	for(uint32_t v = 0; v < n; ++v) {
+		uint64_t pos = offsets[v];
+		auto range = boost::adjacent_vertices(v, g);
+		for(auto it = range.first; it != range.second; ++it) {
+			targets[pos++] = *it;
+		}
+	}
+}
@@ -0,0 +1,57 @@
+/*!
+ * \brief A compact, read-only representation of a Graph for the analysis
+ */
+
+#ifndef CSRGRAPH_H
+#define CSRGRAPH_H
+
+#include "node.h"
+#include <cstdint>
+#include <vector>
+
+/*!
+ * \brief An undirected graph in compressed sparse row format.
+ *
+ * The neighbors of vertex v are stored in targets[offsets[v]] .. targets[offsets[v + 1] - 1],
+ * every edge appears once in the neighbors of both of its vertices.
+ */
+class CSRGraph
+{
+public:
+	/*!
+	 * \brief builds the compact representation of a Graph
+	 * \param g is the Graph to convert
+	 */
+	CSRGraph(Graph& g);
+
+	/*!
+	 * \brief returns the number of vertices
+	 */
+	uint32_t numVertices() const { return offsets.size() - 1; }
+
+	/*!
+	 * \brief returns the number of (undirected) edges
+	 */
+	uint64_t numEdges() const { return targets.size() / 2; }
+
+	/*!
+	 * \brief returns the degree of a vertex
+	 */
+	uint32_t degree(uint32_t v) const { return offsets[v + 1] - offsets[v]; }
+
+	/*!
+	 * \brief returns the first neighbor of a vertex
+	 */
+	const uint32_t* neighborsBegin(uint32_t v) const { return targets.data() + offsets[v]; }
+
+	/*!
+	 * \brief returns the end of the neighbors of a vertex
+	 */
+	const uint32_t* neighborsEnd(uint32_t v) const { return targets.data() + offsets[v + 1]; }
+
+private:
+	std::vector<uint64_t> offsets; //!< the start of the neighbors of every vertex, plus the end
+	std::vector<uint32_t> targets; //!< the neighbors of all vertices
+};
+
+#endif // CSRGRAPH_H
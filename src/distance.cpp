@@ -0,0 +1,281 @@
+#include "distance.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+DistanceHistogram::DistanceHistogram() : disconnectedPairs(0) {}
+
+void DistanceHistogram::add(uint32_t hops, uint64_t count)
+{
+	if(hops >= pairs.size()) {
+		pairs.resize(hops + 1, 0);
+	}
+	pairs[hops] += count;
+}
+
+void DistanceHistogram::addDisconnected(uint64_t count)
+{
+	disconnectedPairs += count;
+}
+
+void DistanceHistogram::merge(const DistanceHistogram& other)
+{
+	for(uint32_t hops = 0; hops < other.pairs.size(); ++hops) {
+		add(hops, other.pairs[hops]);
+	}
+	disconnectedPairs += other.disconnectedPairs;
+}
+
+uint64_t DistanceHistogram::getPairs(uint32_t hops) const
+{
+	return hops < pairs.size() ? pairs[hops] : 0;
+}
+
+uint64_t DistanceHistogram::getConnectedPairs() const
+{
+	uint64_t sum = 0;
+	for(uint64_t count : pairs) {
+		sum += count;
+	}
+	return sum;
+}
+
+uint64_t DistanceHistogram::getDisconnectedPairs() const
+{
+	return disconnectedPairs;
+}
+
+uint32_t DistanceHistogram::getMaxHops() const
+{
+	for(uint32_t hops = pairs.size(); hops > 0; --hops) {
+		if(pairs[hops - 1] > 0) return hops - 1;
+	}
+	return 0;
+}
+
+double DistanceHistogram::getMean() const
+{
+	uint64_t connected = getConnectedPairs();
+	if(connected == 0) return 0;
+
+	double sum = 0;
+	for(uint32_t hops = 0; hops < pairs.size(); ++hops) {
+		sum += (double) hops * pairs[hops];
+	}
+	return sum / connected;
+}
+
+uint32_t DistanceHistogram::getPercentile(double fraction) const
+{
+	uint64_t connected = getConnectedPairs();
+	uint64_t covered = 0;
+	for(uint32_t hops = 0; hops < pairs.size(); ++hops) {
+		covered += pairs[hops];
+		if(covered > 0 && covered >= fraction * connected) return hops;
+	}
+	return getMaxHops();
+}
+
+DistanceHistogram calculateDistanceHistogram(const CSRGraph& g, std::ostream* spill)
+{
+	uint32_t n = g.numVertices();
+	DistanceHistogram histogram;
+
+	// reused by every traversal
+	std::vector<uint32_t> distance(n, UINT32_MAX);
+	std::vector<uint32_t> queue(n);
+	std::vector<uint64_t> sourcePairs;
+
+	if(spill != nullptr) {
+		*spill << "# vertex disconnected_pairs pairs_at_1_hop pairs_at_2_hops ..." << std::endl;
+	}
+
+	for(uint32_t source = 0; source < n; ++source) {
+		sourcePairs.clear();
+		distance[source] = 0;
+		queue[0] = source;
+		uint32_t head = 0, tail = 1;
+		while(head < tail) {
+			uint32_t u = queue[head++];
+			uint32_t d = distance[u] + 1;
+			for(const uint32_t* it = g.neighborsBegin(u); it != g.neighborsEnd(u); ++it) {
+				if(distance[*it] == UINT32_MAX) {
+					distance[*it] = d;
+					queue[tail++] = *it;
+					if(d > sourcePairs.size()) {
+						sourcePairs.resize(d, 0);
+					}
+					sourcePairs[d - 1]++;
+				}
+			}
+		}
+
+		for(uint32_t hops = 1; hops <= sourcePairs.size(); ++hops) {
+			histogram.add(hops, sourcePairs[hops - 1]);
+		}
+		histogram.addDisconnected(n - tail);
+
+		if(spill != nullptr) {
+			*spill << source << " " << n - tail;
+			for(uint64_t count : sourcePairs) {
+				*spill << " " << count;
+			}
+			*spill << "\n";
+		}
+
+		// only reset what this traversal touched
+		for(uint32_t i = 0; i < tail; ++i) {
+			distance[queue[i]] = UINT32_MAX;
+		}
+	}
+
+	return histogram;
+}
+
+/*!
+ * \brief a breadth-first search from source, the caller resets distance for the vertices in queue[0 .. count)
+ * \return the eccentricity of source
+ */
+static uint32_t eccentricity(const CSRGraph& g, uint32_t source, std::vector<uint32_t>& distance, std::vector<uint32_t>& queue, uint32_t& count)
+{
+	distance[source] = 0;
+	queue[0] = source;
+	uint32_t head = 0, tail = 1;
+	while(head < tail) {
+		uint32_t u = queue[head++];
+		for(const uint32_t* it = g.neighborsBegin(u); it != g.neighborsEnd(u); ++it) {
+			if(distance[*it] == UINT32_MAX) {
+				distance[*it] = distance[u] + 1;
+				queue[tail++] = *it;
+			}
+		}
+	}
+	count = tail;
+	return distance[queue[tail - 1]];
+}
+
+static void resetDistances(std::vector<uint32_t>& distance, std::vector<uint32_t>& queue, uint32_t count)
+{
+	for(uint32_t i = 0; i < count; ++i) {
+		distance[queue[i]] = UINT32_MAX;
+	}
+}
+
+uint32_t calculateDiameter(const CSRGraph& g, unsigned long& passes, unsigned int threads)
+{
+	if(threads == 0) {
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	}
+	uint32_t n = g.numVertices();
+	uint32_t diameter = 0;
+	passes = 0;
+
+	std::vector<bool> visited(n, false);
+	std::vector<uint32_t> lower(n, 0), upper(n, UINT32_MAX);
+	std::vector<uint32_t> component, candidates, sources;
+
+	// every traversal of a round has its own distances, they are only allocated for the rounds which need them
+	std::vector<std::vector<uint32_t>> distance, queue;
+	std::vector<uint32_t> ecc, count;
+
+	// the candidates which bound the others best come first: the largest upper or the smallest lower bound, ties go to the higher degree
+	auto byUpper = [&](uint32_t v, uint32_t w) {
+		return upper[v] != upper[w] ? upper[v] > upper[w] : g.degree(v) != g.degree(w) ? g.degree(v) > g.degree(w) : v < w;
+	};
+	auto byLower = [&](uint32_t v, uint32_t w) {
+		return lower[v] != lower[w] ? lower[v] < lower[w] : g.degree(v) != g.degree(w) ? g.degree(v) > g.degree(w) : v < w;
+	};
+
+	for(uint32_t root = 0; root < n; ++root) {
+		if(visited[root]) continue;
+
+		// bounds of the eccentricities of the component's vertices, narrowed by every traversal
+		uint32_t lowerBound = 0, upperBound = UINT32_MAX;
+		uint32_t farthest = root;
+		bool pickHigh = true;
+		component.clear();
+		sources.assign(1, root);
+		for(unsigned int round = 0; ; ++round) {
+			if(distance.size() < sources.size()) {
+				distance.resize(sources.size(), std::vector<uint32_t>(n, UINT32_MAX));
+				queue.resize(sources.size(), std::vector<uint32_t>(n));
+				ecc.resize(sources.size());
+				count.resize(sources.size());
+			}
+
+			//! \constraint the traversals of a round only read the graph, their bounds are applied afterwards in a fixed order
+			std::atomic<unsigned int> next(0);
+			auto worker = [&]() {
+				for(unsigned int i = next++; i < sources.size(); i = next++) {
+					ecc[i] = eccentricity(g, sources[i], distance[i], queue[i], count[i]);
+				}
+			};
+			std::vector<std::thread> workers;
+			for(unsigned int t = 1; t < threads && t < sources.size(); ++t) {
+				workers.emplace_back(worker);
+			}
+			worker();
+			for(std::thread& t : workers) {
+				t.join();
+			}
+			passes += sources.size();
+
+			if(component.empty()) {
+				component.assign(queue[0].begin(), queue[0].begin() + count[0]);
+				candidates = component;
+				for(uint32_t v : component) {
+					visited[v] = true;
+				}
+				farthest = queue[0][count[0] - 1];
+			}
+
+			for(unsigned int i = 0; i < sources.size(); ++i) {
+				lowerBound = std::max(lowerBound, ecc[i]);
+				upperBound = std::min(upperBound, 2 * ecc[i]);
+				uint32_t maxUpper = 0;
+				for(uint32_t v : component) {
+					uint32_t d = distance[i][v];
+					lower[v] = std::max(lower[v], std::max(d, ecc[i] - d));
+					upper[v] = std::min(upper[v], ecc[i] + d);
+					lowerBound = std::max(lowerBound, lower[v]);
+					maxUpper = std::max(maxUpper, upper[v]);
+				}
+				upperBound = std::min(upperBound, maxUpper);
+				resetDistances(distance[i], queue[i], count[i]);
+			}
+			if(lowerBound >= upperBound) break;
+
+			// drop the vertices which can't change the bounds anymore
+			auto settled = [&](uint32_t v) {
+				return lower[v] == upper[v] || (upper[v] <= lowerBound && 2 * lower[v] >= upperBound);
+			};
+			candidates.erase(std::remove_if(std::begin(candidates), std::end(candidates), settled), std::end(candidates));
+			if(candidates.empty()) break;
+
+			// a double sweep from the vertex farthest from the root for the lower bound, then the hub of the component for the upper bounds
+			if(round == 0 && farthest != root) {
+				sources.assign(1, farthest);
+				continue;
+			}
+			if(round <= 1) {
+				uint32_t hub = *std::max_element(std::begin(component), std::end(component), [&](uint32_t v, uint32_t w) { return g.degree(v) < g.degree(w); });
+				if(lower[hub] != upper[hub]) {
+					sources.assign(1, hub);
+					continue;
+				}
+			}
+
+			// then the candidates alternate between the largest upper and the smallest lower bound, a round holds one per thread
+			uint32_t size = std::min<size_t>(threads, candidates.size());
+			uint32_t highs = (size + pickHigh) / 2;
+			std::partial_sort(std::begin(candidates), std::begin(candidates) + highs, std::end(candidates), byUpper);
+			std::partial_sort(std::begin(candidates) + highs, std::begin(candidates) + size, std::end(candidates), byLower);
+			sources.assign(std::begin(candidates), std::begin(candidates) + size);
+			pickHigh = !pickHigh;
+		}
+
+		diameter = std::max(diameter, lowerBound);
+	}
+
+	return diameter;
+}
@@ -0,0 +1,100 @@
+/*!
+ * \brief The shortest path length distribution of a graph
+ */
+
+#ifndef DISTANCE_H
+#define DISTANCE_H
+
+#include "csrgraph.h"
+#include <cstdint>
+#include <vector>
+#include <ostream>
+
+/*!
+ * \brief Counts the (ordered) vertex pairs of a graph by their hop distance.
+ */
+class DistanceHistogram
+{
+public:
+	DistanceHistogram();
+
+	/*!
+	 * \brief counts pairs at a hop distance
+	 * \param hops is the distance of the pairs.
+	 * \param count is the number of pairs.
+	 */
+	void add(uint32_t hops, uint64_t count = 1);
+
+	/*!
+	 * \brief counts pairs which aren't connected by any path
+	 * \param count is the number of pairs.
+	 */
+	void addDisconnected(uint64_t count);
+
+	/*!
+	 * \brief adds the counts of another histogram
+	 */
+	void merge(const DistanceHistogram& other);
+
+	/*!
+	 * \brief returns the number of pairs at a hop distance
+	 */
+	uint64_t getPairs(uint32_t hops) const;
+
+	/*!
+	 * \brief returns the number of pairs connected by a path
+	 */
+	uint64_t getConnectedPairs() const;
+
+	/*!
+	 * \brief returns the number of pairs not connected by any path
+	 */
+	uint64_t getDisconnectedPairs() const;
+
+	/*!
+	 * \brief returns the largest hop distance of a connected pair, aka the diameter
+	 */
+	uint32_t getMaxHops() const;
+
+	/*!
+	 * \brief returns the mean hop distance of the connected pairs
+	 */
+	double getMean() const;
+
+	/*!
+	 * \brief returns the hop distance which covers a fraction of the connected pairs
+	 * \param fraction is the fraction of connected pairs, e.g. 0.9 for the 90th percentile.
+	 */
+	uint32_t getPercentile(double fraction) const;
+
+private:
+	std::vector<uint64_t> pairs; //!< number of pairs per hop distance
+	uint64_t disconnectedPairs; //!< number of pairs without a path
+};
+
+/*!
+ * \brief calculates the hop distance distribution with one breadth-first search per vertex
+ *
+ * Only O(V) memory is used, the distances of a source are folded into the histogram right after its traversal.
+ * \param g is the graph to analyze.
+ * \param spill if not nullptr, the distribution of every single source is written to it, one line per source.
+ * \return the distribution of all ordered pairs
+ */
+DistanceHistogram calculateDistanceHistogram(const CSRGraph& g, std::ostream* spill = nullptr);
+
+/*!
+ * \brief calculates the exact diameter by narrowing bounds of the eccentricities (Takes and Kosters' BoundingDiameters)
+ *
+ * A traversal from v with eccentricity e bounds every vertex w of its component to
+ * max(d(v, w), e - d(v, w)) <= ecc(w) <= e + d(v, w). Every component starts with a double sweep for the
+ * lower bound and a traversal from its highest-degree vertex for the upper bounds, then the traversals
+ * alternate between the vertices with the largest upper and the smallest lower bound, vertices which can't
+ * change the bounds of the diameter anymore are dropped. The traversals of a round run in parallel.
+ * \param g is the graph to analyze.
+ * \param passes will hold the number of breadth-first searches which were needed.
+ * \param threads is the number of traversals per round, 0 uses one per hardware thread.
+ * \return the largest hop distance of a connected pair
+ */
+uint32_t calculateDiameter(const CSRGraph& g, unsigned long& passes, unsigned int threads = 1);
+
+#endif // DISTANCE_H
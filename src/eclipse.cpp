@@ -0,0 +1,184 @@
+#include "eclipse.h"
+#include "constants.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+/*!
+ * \brief sets the share and the 95% Wilson score interval of an estimate
+ *
+ * Unlike the normal approximation the interval stays inside [0, 1] and doesn't collapse when
+ * no trial or every trial was eclipsed, which is common for small attacker fractions.
+ */
+static void wilsonInterval(EclipseEstimate& estimate)
+{
+	if(estimate.trials == 0) return;
+	double n = estimate.trials;
+	double p = estimate.eclipsed / n;
+	double z2 = ECLIPSEZ * ECLIPSEZ;
+	double center = (p + z2 / (2 * n)) / (1 + z2 / n);
+	double half = ECLIPSEZ / (1 + z2 / n) * std::sqrt(p * (1 - p) / n + z2 / (4 * n * n));
+	estimate.probability = p;
+	estimate.lower = std::max(0.0, center - half);
+	estimate.upper = std::min(1.0, center + half);
+}
+
+EclipseEngine::EclipseEngine(const Node::vector& nodes, unsigned int maxOutbound, unsigned int threads) : maxOutbound(maxOutbound), threads(threads)
+{
+	if(this->threads == 0) {
+		this->threads = std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	// the tables refer to the online nodes by their position in nodes
+	std::vector<uint32_t> position;
+	for(uint32_t v = 0; v < nodes.size(); ++v) {
+		unsigned long index = nodes[v]->getIndex();
+		if(index == NOINDEX) continue;
+		if(index >= position.size()) {
+			position.resize(index + 1, UNREACHABLE);
+		}
+		position[index] = v;
+	}
+
+	accepts.resize(nodes.size(), false);
+	for(uint32_t v = 0; v < nodes.size(); ++v) {
+		if(!nodes[v]->isReachable()) continue;
+		servers.push_back(v);
+		accepts[v] = nodes[v]->getConnections().size() < MAXCONNECTEDPEERS;
+	}
+
+	offsets.reserve(nodes.size() + 1);
+	offsets.push_back(0);
+	for(uint32_t v = 0; v < nodes.size(); ++v) {
+		for(const Node::ptr& node : nodes[v]->getKnownNodes()) {
+			unsigned long index = node->getIndex();
+			bool reachable = index < position.size() && position[index] != UNREACHABLE && node->isReachable();
+			known.push_back(reachable ? position[index] : UNREACHABLE);
+		}
+		offsets.push_back(known.size());
+		if(offsets[v + 1] > offsets[v]) {
+			victims.push_back(v);
+		}
+	}
+}
+
+void EclipseEngine::randomizeTables(unsigned long seed)
+{
+	//! \constraint the random tables have as many entries as the real ones, drawn uniformly from the online servers, only the tables differ from the snapshot
+	// like the real tables, a table holds distinct servers and never the node itself, a partial shuffle draws them
+	std::mt19937 rng(seed);
+	std::vector<uint32_t> pool(servers);
+	for(uint32_t v = 0; v + 1 < offsets.size(); ++v) {
+		uint64_t size = offsets[v + 1] - offsets[v], filled = 0;
+		for(size_t i = 0; i < pool.size() && filled < size; ++i) {
+			std::swap(pool[i], pool[std::uniform_int_distribution<size_t>(i, pool.size() - 1)(rng)]);
+			if(pool[i] != v) {
+				known[offsets[v] + filled++] = pool[i];
+			}
+		}
+		for(; filled < size; ++filled) {
+			known[offsets[v] + filled] = UNREACHABLE;
+		}
+	}
+}
+
+EclipseStats EclipseEngine::estimate(unsigned long trials, unsigned long seed)
+{
+	EclipseStats stats;
+	stats.victims = victims.size();
+	unsigned long stale = 0, entries = 0;
+	for(uint32_t victim : victims) {
+		entries += offsets[victim + 1] - offsets[victim];
+	}
+	for(uint32_t entry : known) {
+		stale += entry == UNREACHABLE;
+	}
+	stats.meanTable = victims.empty() ? 0 : (double) entries / victims.size();
+	stats.staleShare = known.empty() ? 0 : (double) stale / known.size();
+	unsigned long full = 0;
+	for(uint32_t server : servers) {
+		full += !accepts[server];
+	}
+	stats.fullShare = servers.empty() ? 0 : (double) full / servers.size();
+	if(victims.empty() || trials == 0) return stats;
+
+	// a block of trials always uses the same stream, so the estimate doesn't depend on the number of threads
+	unsigned long blocksPerFraction = (trials + ECLIPSEBLOCK - 1) / ECLIPSEBLOCK;
+	unsigned long blocks = blocksPerFraction * ECLIPSEFRACTIONS;
+	std::vector<std::vector<unsigned long>> partial(threads, std::vector<unsigned long>(ECLIPSEFRACTIONS, 0));
+	std::atomic<unsigned long> nextBlock(0);
+
+	auto worker = [&](unsigned int id) {
+		std::vector<std::pair<uint32_t, bool>> attackers;
+		std::vector<uint32_t> connected;
+		std::vector<unsigned long>& eclipsed = partial[id];
+		for(unsigned long block = nextBlock++; block < blocks; block = nextBlock++) {
+			unsigned int f = block / blocksPerFraction;
+			unsigned long first = (block % blocksPerFraction) * ECLIPSEBLOCK;
+			unsigned long last = std::min(trials, first + ECLIPSEBLOCK);
+			std::mt19937 rng(seed + block);
+			std::uniform_int_distribution<size_t> pickVictim(0, victims.size() - 1);
+			for(unsigned long t = first; t < last; ++t) {
+				eclipsed[f] += trial(victims[pickVictim(rng)], ECLIPSEFRACTION[f], rng, attackers, connected);
+			}
+		}
+	};
+
+	std::vector<std::thread> workers;
+	for(unsigned int id = 1; id < threads && id < blocks; ++id) {
+		workers.emplace_back(worker, id);
+	}
+	worker(0);
+	for(std::thread& t : workers) {
+		t.join();
+	}
+
+	for(unsigned int f = 0; f < ECLIPSEFRACTIONS; ++f) {
+		EclipseEstimate& estimate = stats.estimates[f];
+		estimate.trials = trials;
+		for(std::vector<unsigned long>& eclipsed : partial) {
+			estimate.eclipsed += eclipsed[f];
+		}
+		wilsonInterval(estimate);
+	}
+	return stats;
+}
+
+bool EclipseEngine::trial(uint32_t victim, double fraction, std::mt19937& rng, std::vector<std::pair<uint32_t, bool>>& attackers, std::vector<uint32_t>& connected)
+{
+	attackers.clear();
+	connected.clear();
+	uint64_t begin = offsets[victim];
+	uint64_t size = offsets[victim + 1] - begin;
+	std::uniform_int_distribution<uint64_t> pickAddress(0, size - 1);
+	std::bernoulli_distribution attacker(fraction);
+
+	//! \constraint like fillConnections the victim wants at most as many connections as it knows addresses
+	unsigned int wanted = std::min<uint64_t>(maxOutbound, size);
+	bool progress = true;
+	while(progress && connected.size() < wanted) {
+		progress = false;
+		for(unsigned int tries = 0; tries < ECLIPSETRIES && connected.size() < wanted; ++tries) {
+			uint32_t target = known[begin + pickAddress(rng)];
+			if(target == UNREACHABLE || target == victim) continue;
+
+			// the side of a server is only decided when it is drawn the first time
+			auto decided = std::find_if(std::begin(attackers), std::end(attackers), [target](const std::pair<uint32_t, bool>& a) { return a.first == target; });
+			if(decided == std::end(attackers)) {
+				attackers.emplace_back(target, attacker(rng));
+				decided = std::end(attackers) - 1;
+			}
+			if(!decided->second) {
+				// a single honest connection ends the eclipse
+				if(accepts[target]) return false;
+				continue;
+			}
+			if(std::find(std::begin(connected), std::end(connected), target) == std::end(connected)) {
+				connected.push_back(target);
+				progress = true;
+			}
+		}
+	}
+	return connected.size() == wanted;
+}
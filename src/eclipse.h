@@ -0,0 +1,101 @@
+/*!
+ * \brief How likely an attacker fills all outbound connections of a node
+ */
+
+#ifndef ECLIPSE_H
+#define ECLIPSE_H
+
+#include "node.h"
+#include <cstdint>
+#include <random>
+#include <vector>
+
+/*!
+ * \brief The fractions of the online servers the attacker controls the eclipse probability is estimated for
+ */
+static const double ECLIPSEFRACTION[] = {0.1, 0.2, 0.3, 0.5, 0.7, 0.9};
+static const unsigned int ECLIPSEFRACTIONS = sizeof(ECLIPSEFRACTION) / sizeof(ECLIPSEFRACTION[0]);
+
+static const unsigned long ECLIPSEBLOCK = 4096; //!< the trials drawn from one random number stream
+static const unsigned int ECLIPSETRIES = 100; //!< the addresses a victim tries per fill of its connections, as in fillConnections
+static const uint32_t UNREACHABLE = UINT32_MAX; //!< an address which can't be connected to
+static const double ECLIPSEZ = 1.96; //!< the quantile of the normal distribution for the 95% confidence intervals
+
+/*!
+ * \brief The eclipse probability at one attacker fraction.
+ */
+typedef struct EclipseEstimate {
+	unsigned long trials = 0; //!< the number of trials
+	unsigned long eclipsed = 0; //!< the trials in which the attacker got all outbound connections of the victim
+	double probability = 0; //!< the share of the eclipsed trials
+	double lower = 0; //!< the lower bound of the 95% Wilson score interval
+	double upper = 0; //!< the upper bound of the 95% Wilson score interval
+} EclipseEstimate;
+
+/*!
+ * \brief The eclipse probabilities at all attacker fractions.
+ */
+typedef struct EclipseStats {
+	EclipseEstimate estimates[ECLIPSEFRACTIONS]; //!< per fraction of ECLIPSEFRACTION
+	uint32_t victims = 0; //!< the online nodes which know at least one address, the victims are drawn from them
+	double meanTable = 0; //!< the mean number of known addresses of a victim
+	double staleShare = 0; //!< the share of the known addresses which can't be connected to (offline nodes or clients)
+	double fullShare = 0; //!< the share of the online servers without a free slot, they only take connections of the attacker
+} EclipseStats;
+
+/*!
+ * \brief Estimates the probability that an attacker owns all outbound connections of a restarting node.
+ *
+ * The engine takes a snapshot of the address tables of the online nodes. A trial draws a victim, makes
+ * every online server an attacker with the given probability and lets the victim fill its outbound
+ * connections like fillConnections: it picks random addresses of its table, ECLIPSETRIES per fill, and
+ * fills again as long as a fill adds a connection. Offline nodes and clients can't be connected to and
+ * honest servers only accept while they have free slots, the attacker always accepts. The victim is
+ * eclipsed if all its connections go to the attacker. The attackers are only decided for the addresses
+ * a trial draws, so a trial costs a few dozen steps whatever the size of the network.
+ */
+class EclipseEngine
+{
+public:
+	/*!
+	 * \param nodes are the online nodes.
+	 * \param maxOutbound is the number of outbound connections a node makes.
+	 * \param threads is the number of threads for the trials, 0 uses one per hardware thread.
+	 */
+	EclipseEngine(const Node::vector& nodes, unsigned int maxOutbound, unsigned int threads);
+
+	/*!
+	 * \brief replaces every address table by as many addresses of online servers drawn uniformly at random, the baseline
+	 * \param seed seeds the random number generator.
+	 */
+	void randomizeTables(unsigned long seed);
+
+	/*!
+	 * \brief runs the trials at every fraction of ECLIPSEFRACTION
+	 * \param trials is the number of trials per fraction.
+	 * \param seed seeds the random number generator of the first block of ECLIPSEBLOCK trials, the others use the following seeds.
+	 */
+	EclipseStats estimate(unsigned long trials, unsigned long seed);
+
+private:
+	/*!
+	 * \brief fills the outbound connections of a victim against a random attacker
+	 * \param victim is the index of the victim.
+	 * \param fraction is the probability of a server to be an attacker.
+	 * \param rng is the random number generator of the trial.
+	 * \param attackers holds the servers whose side was decided, reused between the trials.
+	 * \param connected holds the attackers the victim connected to, reused between the trials.
+	 * \return true if the victim is eclipsed
+	 */
+	bool trial(uint32_t victim, double fraction, std::mt19937& rng, std::vector<std::pair<uint32_t, bool>>& attackers, std::vector<uint32_t>& connected);
+
+	std::vector<uint64_t> offsets; //!< the first entry of the address table of every node in known
+	std::vector<uint32_t> known; //!< the address tables, an entry is a node index or UNREACHABLE
+	std::vector<bool> accepts; //!< the servers which have a free slot for an honest connection
+	std::vector<uint32_t> servers; //!< the online servers
+	std::vector<uint32_t> victims; //!< the nodes with a non-empty address table
+	unsigned int maxOutbound; //!< the outbound connections of a node
+	unsigned int threads; //!< the number of threads
+};
+
+#endif // ECLIPSE_H
@@ -0,0 +1,182 @@
+#include "layout.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <random>
+#include <thread>
+
+static const double EDGELENGTH = 36; //!< the ideal edge length in points
+static const double THETA = 0.8; //!< cells which appear smaller than this (size / distance) are approximated
+static const double GRAVITY = 0.5; //!< the pull towards the center, keeps components and isolated vertices in view
+static const unsigned int MAXTREEDEPTH = 32; //!< deeper cells are leaves, even with several (coincident) vertices
+static const uint32_t FORCEBLOCKSIZE = 256; //!< the number of vertices a thread takes at once
+
+ForceLayout::ForceLayout(const CSRGraph& g, unsigned int threads) : g(g), threads(threads), k(EDGELENGTH)
+{
+	if(this->threads == 0) {
+		this->threads = std::max(1u, std::thread::hardware_concurrency());
+	}
+}
+
+std::vector<LayoutPoint> ForceLayout::calculate(unsigned int iterations)
+{
+	uint32_t n = g.numVertices();
+	double side = k * std::sqrt((double) n);
+
+	// a fixed seed, so the same graph always gets the same picture
+	std::mt19937 rng(0);
+	std::uniform_real_distribution<double> coordinate(0, side);
+	points.resize(n);
+	for(LayoutPoint& p : points) {
+		p.x = coordinate(rng);
+		p.y = coordinate(rng);
+	}
+	if(n < 2) return points;
+
+	std::vector<uint32_t> order(n);
+	std::vector<LayoutPoint> forces(n);
+	for(unsigned int i = 0; i < iterations; ++i) {
+		// the quadtree over the bounding square of the current coordinates
+		double minX = points[0].x, minY = points[0].y, maxX = minX, maxY = minY;
+		for(LayoutPoint& p : points) {
+			minX = std::min(minX, p.x);
+			minY = std::min(minY, p.y);
+			maxX = std::max(maxX, p.x);
+			maxY = std::max(maxY, p.y);
+		}
+		for(uint32_t v = 0; v < n; ++v) {
+			order[v] = v;
+		}
+		cells.assign(1, Cell());
+		buildCell(0, order.data(), order.data() + n, minX, minY, std::max(maxX - minX, maxY - minY) * (1 + 1e-9) + 1e-9, 0);
+
+		std::atomic<uint32_t> nextBlock(0);
+		uint32_t blocks = (n + FORCEBLOCKSIZE - 1) / FORCEBLOCKSIZE;
+		auto worker = [&]() {
+			for(uint32_t block = nextBlock++; block < blocks; block = nextBlock++) {
+				uint32_t end = std::min(n, (block + 1) * FORCEBLOCKSIZE);
+				for(uint32_t v = block * FORCEBLOCKSIZE; v < end; ++v) {
+					calculateForces(v, forces[v]);
+				}
+			}
+		};
+
+		std::vector<std::thread> workers;
+		for(unsigned int t = 1; t < threads && t < blocks; ++t) {
+			workers.emplace_back(worker);
+		}
+		worker();
+		for(std::thread& t : workers) {
+			t.join();
+		}
+
+		// the movement of a vertex is capped by the temperature, which cools down linearly
+		double temperature = side / 10 * (1 - (double) i / iterations);
+		for(uint32_t v = 0; v < n; ++v) {
+			double length = std::sqrt(forces[v].x * forces[v].x + forces[v].y * forces[v].y);
+			if(length <= 0) continue;
+			double step = std::min(length, temperature) / length;
+			points[v].x += forces[v].x * step;
+			points[v].y += forces[v].y * step;
+		}
+	}
+
+	// graphviz expects positive coordinates
+	double minX = points[0].x, minY = points[0].y;
+	for(LayoutPoint& p : points) {
+		minX = std::min(minX, p.x);
+		minY = std::min(minY, p.y);
+	}
+	for(LayoutPoint& p : points) {
+		p.x -= minX;
+		p.y -= minY;
+	}
+	return points;
+}
+
+void ForceLayout::buildCell(uint32_t cell, uint32_t* begin, uint32_t* end, double x, double y, double size, unsigned int depth)
+{
+	double sumX = 0, sumY = 0;
+	for(uint32_t* v = begin; v < end; ++v) {
+		sumX += points[*v].x;
+		sumY += points[*v].y;
+	}
+	cells[cell].mass = end - begin;
+	cells[cell].x = sumX / cells[cell].mass;
+	cells[cell].y = sumY / cells[cell].mass;
+	cells[cell].size = size;
+	if(end - begin == 1 || depth >= MAXTREEDEPTH) return;
+
+	// split the vertices into the four quadrants
+	double half = size / 2;
+	uint32_t* quadrants[5];
+	quadrants[0] = begin;
+	quadrants[4] = end;
+	quadrants[2] = std::partition(begin, end, [&](uint32_t v) { return points[v].y < y + half; });
+	quadrants[1] = std::partition(begin, quadrants[2], [&](uint32_t v) { return points[v].x < x + half; });
+	quadrants[3] = std::partition(quadrants[2], end, [&](uint32_t v) { return points[v].x < x + half; });
+
+	// the non-empty children are stored in a row
+	uint8_t children = 0;
+	for(unsigned int q = 0; q < 4; ++q) {
+		if(quadrants[q] != quadrants[q + 1]) children++;
+	}
+	uint32_t firstChild = cells.size();
+	cells[cell].firstChild = firstChild;
+	cells[cell].children = children;
+	cells.resize(cells.size() + children);
+
+	uint32_t child = firstChild;
+	for(unsigned int q = 0; q < 4; ++q) {
+		if(quadrants[q] == quadrants[q + 1]) continue;
+		buildCell(child++, quadrants[q], quadrants[q + 1], x + (q & 1) * half, y + (q >> 1) * half, half, depth + 1);
+	}
+}
+
+void ForceLayout::calculateForces(uint32_t v, LayoutPoint& force) const
+{
+	const LayoutPoint& p = points[v];
+	force.x = 0;
+	force.y = 0;
+
+	// repulsion: k^2 / d from every vertex, distant cells act as a single mass
+	std::vector<uint32_t> stack(1, 0);
+	while(!stack.empty()) {
+		const Cell& cell = cells[stack.back()];
+		stack.pop_back();
+
+		double dx = p.x - cell.x, dy = p.y - cell.y;
+		double distance2 = dx * dx + dy * dy;
+		if(cell.children == 0 || cell.size * cell.size < THETA * THETA * distance2) {
+			// the cell of the vertex itself has no distance
+			if(distance2 > 1e-12) {
+				double f = cell.mass * k * k / distance2;
+				force.x += dx * f;
+				force.y += dy * f;
+			}
+			continue;
+		}
+		for(uint32_t child = cell.firstChild; child < cell.firstChild + cell.children; ++child) {
+			stack.push_back(child);
+		}
+	}
+
+	// attraction: d^2 / k along every edge
+	for(const uint32_t* u = g.neighborsBegin(v); u != g.neighborsEnd(v); ++u) {
+		double dx = points[*u].x - p.x, dy = points[*u].y - p.y;
+		double distance = std::sqrt(dx * dx + dy * dy);
+		force.x += dx * distance / k;
+		force.y += dy * distance / k;
+	}
+
+	// gravity towards the center of mass of all vertices
+	force.x -= (p.x - cells[0].x) * GRAVITY;
+	force.y -= (p.y - cells[0].y) * GRAVITY;
+}
+
+PositionWriter::PositionWriter(const std::vector<LayoutPoint>& points) : points(points) {}
+
+void PositionWriter::operator()(std::ostream& out, const Vertex& v) const
+{
+	out << "[pos=\"" << points[v].x << "," << points[v].y << "\"]";
+}
@@ -0,0 +1,95 @@
+/*!
+ * \brief A force-directed layout of a graph, so external tools only have to draw it
+ */
+
+#ifndef LAYOUT_H
+#define LAYOUT_H
+
+#include "csrgraph.h"
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+/*!
+ * \brief The coordinates of a vertex in points.
+ */
+typedef struct LayoutPoint {
+	double x = 0; //!< the horizontal coordinate
+	double y = 0; //!< the vertical coordinate
+} LayoutPoint;
+
+/*!
+ * \brief Lays a CSRGraph out with the forces of Fruchterman and Reingold.
+ *
+ * Edges pull their vertices together, all vertices push each other apart. The repulsion is
+ * approximated with a Barnes-Hut quadtree, so an iteration takes O(V log V + E) instead of O(V^2).
+ * The tree is built once per iteration, the forces on the vertices are calculated in parallel.
+ */
+class ForceLayout
+{
+public:
+	/*!
+	 * \param g is the graph to lay out.
+	 * \param threads is the number of threads, 0 uses one per hardware thread.
+	 */
+	ForceLayout(const CSRGraph& g, unsigned int threads);
+
+	/*!
+	 * \brief calculates the coordinates of all vertices
+	 * \param iterations is the number of iterations, the movement cools down linearly over them.
+	 * \return the coordinates, indexed by vertex
+	 */
+	std::vector<LayoutPoint> calculate(unsigned int iterations);
+
+private:
+	/*!
+	 * \brief A square cell of the quadtree, summarised by the center of mass of its vertices.
+	 */
+	typedef struct Cell {
+		double x = 0; //!< the horizontal center of mass
+		double y = 0; //!< the vertical center of mass
+		double size = 0; //!< the side length of the cell
+		uint32_t mass = 0; //!< the number of vertices in the cell
+		uint32_t firstChild = 0; //!< the index of the first child cell, the children are stored in a row
+		uint8_t children = 0; //!< the number of non-empty children, 0 for a leaf
+	} Cell;
+
+	/*!
+	 * \brief builds a cell and its children over a range of vertices, they are reordered by quadrant
+	 * \param cell is the index of the cell.
+	 * \param begin is the first vertex in the cell.
+	 * \param end is the end of the vertices in the cell.
+	 * \param x is the left edge of the cell.
+	 * \param y is the bottom edge of the cell.
+	 * \param size is the side length of the cell.
+	 * \param depth is the depth of the cell in the tree.
+	 */
+	void buildCell(uint32_t cell, uint32_t* begin, uint32_t* end, double x, double y, double size, unsigned int depth);
+
+	void calculateForces(uint32_t v, LayoutPoint& force) const; //!< sums the forces acting on a vertex
+
+	const CSRGraph& g; //!< the graph to lay out
+	unsigned int threads; //!< the number of threads
+	double k; //!< the ideal edge length
+	std::vector<LayoutPoint> points; //!< the current coordinates
+	std::vector<Cell> cells; //!< the quadtree of the current iteration, the root comes first
+};
+
+/*!
+ * \brief Writes the coordinates of a vertex as graphviz pos attribute, for write_graphviz.
+ */
+class PositionWriter
+{
+public:
+	/*!
+	 * \param points are the coordinates, indexed by vertex.
+	 */
+	PositionWriter(const std::vector<LayoutPoint>& points);
+
+	void operator()(std::ostream& out, const Vertex& v) const; //!< writes the attribute list of a vertex
+
+private:
+	const std::vector<LayoutPoint>& points; //!< the coordinates
+};
+
+#endif // LAYOUT_H
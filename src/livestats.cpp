@@ -0,0 +1,123 @@
+#include "livestats.h"
+#include <algorithm>
+#include <iterator>
+
+static uint64_t edgeKey(uint32_t a, uint32_t b)
+{
+	return a < b ? ((uint64_t) a << 32) | b : ((uint64_t) b << 32) | a;
+}
+
+LiveStats::LiveStats(uint32_t numberOfNodes) : neighbors(numberOfNodes), vertexTriangles(numberOfNodes, 0), clustering(numberOfNodes, 0), degrees(1, numberOfNodes), clusteringSum(0), edges(0), triangles(0), wedges(0) {}
+
+void LiveStats::connectionOpened(uint32_t a, uint32_t b)
+{
+	if(a == b || a >= neighbors.size() || b >= neighbors.size()) return;
+	if(references[edgeKey(a, b)]++ == 0) {
+		addEdge(a, b);
+	}
+}
+
+void LiveStats::connectionClosed(uint32_t a, uint32_t b)
+{
+	auto it = references.find(edgeKey(a, b));
+	if(it == std::end(references)) return;
+
+	if(--it->second == 0) {
+		references.erase(it);
+		removeEdge(a, b);
+	}
+}
+
+std::vector<uint32_t> LiveStats::commonNeighbors(uint32_t a, uint32_t b) const
+{
+	std::vector<uint32_t> common;
+	std::set_intersection(std::begin(neighbors[a]), std::end(neighbors[a]), std::begin(neighbors[b]), std::end(neighbors[b]), std::back_inserter(common));
+	return common;
+}
+
+void LiveStats::addEdge(uint32_t a, uint32_t b)
+{
+	std::vector<uint32_t> common = commonNeighbors(a, b);
+
+	// every common neighbor closes a new triangle, every neighbor of a and b a new wedge
+	triangles += common.size();
+	wedges += neighbors[a].size() + neighbors[b].size();
+	edges++;
+	for(uint32_t w : common) {
+		vertexTriangles[w]++;
+		updateClustering(w);
+	}
+
+	for(uint32_t v : {a, b}) {
+		uint32_t u = v == a ? b : a;
+		neighbors[v].insert(std::lower_bound(std::begin(neighbors[v]), std::end(neighbors[v]), u), u);
+		vertexTriangles[v] += common.size();
+		moveDegree(neighbors[v].size() - 1, neighbors[v].size());
+		updateClustering(v);
+	}
+}
+
+void LiveStats::removeEdge(uint32_t a, uint32_t b)
+{
+	for(uint32_t v : {a, b}) {
+		uint32_t u = v == a ? b : a;
+		neighbors[v].erase(std::lower_bound(std::begin(neighbors[v]), std::end(neighbors[v]), u));
+	}
+	std::vector<uint32_t> common = commonNeighbors(a, b);
+
+	triangles -= common.size();
+	wedges -= neighbors[a].size() + neighbors[b].size();
+	edges--;
+	for(uint32_t w : common) {
+		vertexTriangles[w]--;
+		updateClustering(w);
+	}
+
+	for(uint32_t v : {a, b}) {
+		vertexTriangles[v] -= common.size();
+		moveDegree(neighbors[v].size() + 1, neighbors[v].size());
+		updateClustering(v);
+	}
+}
+
+void LiveStats::moveDegree(uint32_t from, uint32_t to)
+{
+	if(to >= degrees.size()) {
+		degrees.resize(to + 1, 0);
+	}
+	degrees[from]--;
+	degrees[to]++;
+}
+
+void LiveStats::updateClustering(uint32_t v)
+{
+	uint64_t degree = neighbors[v].size();
+	double local = degree < 2 ? 0 : 2.0 * vertexTriangles[v] / (degree * (degree - 1));
+	clusteringSum += local - clustering[v];
+	clustering[v] = local;
+}
+
+double LiveStats::getTransitivity() const
+{
+	return wedges == 0 ? 0 : 3.0 * triangles / wedges;
+}
+
+double LiveStats::getMeanClustering() const
+{
+	uint64_t active = neighbors.size() - degrees[0];
+	return active == 0 ? 0 : std::max(0.0, clusteringSum) / active;
+}
+
+double LiveStats::getMeanDegree() const
+{
+	uint64_t active = neighbors.size() - degrees[0];
+	return active == 0 ? 0 : 2.0 * edges / active;
+}
+
+uint32_t LiveStats::getMaxDegree() const
+{
+	for(uint32_t degree = degrees.size(); degree > 0; --degree) {
+		if(degrees[degree - 1] > 0) return degree - 1;
+	}
+	return 0;
+}
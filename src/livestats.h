@@ -0,0 +1,91 @@
+/*!
+ * \brief Triangle and degree statistics which follow the topology edge by edge
+ */
+
+#ifndef LIVESTATS_H
+#define LIVESTATS_H
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+/*!
+ * \brief Keeps the triangle count, wedge count, local clustering and degree histogram of the topology up to date.
+ *
+ * An edge exists while at least one of its Nodes holds a connection to the other. Adding or removing
+ * an edge (a, b) only changes the triangles through the common neighbors of a and b and the degrees of
+ * a and b, so an update takes O(degree(a) + degree(b)) and the statistics can be read at any tick.
+ */
+class LiveStats
+{
+public:
+	typedef std::shared_ptr<LiveStats> ptr; //!< a shared_ptr of type LiveStats.
+
+	/*!
+	 * \param numberOfNodes is the size of the node population.
+	 */
+	LiveStats(uint32_t numberOfNodes);
+
+	/*!
+	 * \brief records that a Node opened a connection to another one
+	 * \param a is the index of the Node which holds the connection.
+	 * \param b is the index of its peer.
+	 */
+	void connectionOpened(uint32_t a, uint32_t b);
+
+	/*!
+	 * \brief records that a Node closed its connection to another one
+	 * \param a is the index of the Node which held the connection.
+	 * \param b is the index of its peer.
+	 */
+	void connectionClosed(uint32_t a, uint32_t b);
+
+	uint64_t getEdges() const { return edges; } //!< returns the number of edges
+	uint64_t getTriangles() const { return triangles; } //!< returns the number of triangles
+	uint64_t getWedges() const { return wedges; } //!< returns the number of paths of length two
+
+	/*!
+	 * \brief returns the global clustering coefficient: 3 * triangles / wedges
+	 */
+	double getTransitivity() const;
+
+	/*!
+	 * \brief returns the mean local clustering coefficient of the vertices with at least one edge
+	 */
+	double getMeanClustering() const;
+
+	/*!
+	 * \brief returns the mean degree of the vertices with at least one edge
+	 */
+	double getMeanDegree() const;
+
+	/*!
+	 * \brief returns the largest degree
+	 */
+	uint32_t getMaxDegree() const;
+
+	/*!
+	 * \brief returns the number of vertices per degree, including the ones without an edge
+	 */
+	const std::vector<uint64_t>& getDegreeHistogram() const { return degrees; }
+
+private:
+	void addEdge(uint32_t a, uint32_t b); //!< inserts an edge and updates the statistics
+	void removeEdge(uint32_t a, uint32_t b); //!< removes an edge and updates the statistics
+	std::vector<uint32_t> commonNeighbors(uint32_t a, uint32_t b) const; //!< the common neighbors of two vertices
+	void moveDegree(uint32_t from, uint32_t to); //!< moves a vertex from one degree to another in the histogram
+	void updateClustering(uint32_t v); //!< recalculates the local clustering coefficient of a vertex
+
+	std::unordered_map<uint64_t, uint8_t> references; //!< per edge: the number of its Nodes holding a connection to the other
+	std::vector<std::vector<uint32_t>> neighbors; //!< the sorted neighbors of every vertex
+	std::vector<uint32_t> vertexTriangles; //!< the number of triangles through every vertex
+	std::vector<double> clustering; //!< the local clustering coefficient of every vertex
+	std::vector<uint64_t> degrees; //!< the number of vertices per degree
+	double clusteringSum; //!< the sum of the local clustering coefficients
+	uint64_t edges; //!< the number of edges
+	uint64_t triangles; //!< the number of triangles
+	uint64_t wedges; //!< the number of paths of length two
+};
+
+#endif // LIVESTATS_H
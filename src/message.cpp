@@ -0,0 +1,96 @@
+#include "message.h"
+#include "shard.h"
+
+MessageBus::MessageBus() : posted(), postedAddrs(0) {}
+
+MessageBus::~MessageBus() {}
+
+void MessageBus::post(Message::Type type, const Node::ptr& sender, const Node::ptr& receiver, Node::vector* addr)
+{
+	posted[type]++;
+	if(addr != nullptr) {
+		postedAddrs += addr->size();
+	}
+
+	if(shard != nullptr && !shard->isLocal(receiver)) {
+		shard->post(type, sender, receiver, addr);
+		if(addr != nullptr) {
+			releaseAddrBuffer(addr);
+		}
+		return;
+	}
+
+	Message msg;
+	msg.type = type;
+	msg.sender = sender;
+	msg.receiver = receiver;
+	msg.addr = addr;
+	queue.push_back(msg);
+}
+
+void MessageBus::deliver()
+{
+	// messages sent while delivering go to the next batch of the same tick
+	while(!queue.empty()) {
+		batch.swap(queue);
+		for(Message& msg : batch) {
+			dispatch(msg);
+		}
+		batch.clear();
+	}
+}
+
+void MessageBus::dispatch(Message& msg)
+{
+	//! \constraint messages to nodes which went offline in the meantime are dropped
+	if(msg.receiver->isOnline()) {
+		switch(msg.type) {
+			case Message::VERSION:
+				msg.receiver->recvVersionMsg(msg.sender);
+				break;
+			case Message::GETADDR:
+				msg.receiver->recvGetaddrMsg(msg.sender);
+				break;
+			case Message::ADDR:
+				msg.receiver->recvAddrMsg(msg.sender, *msg.addr);
+				break;
+		}
+	}
+
+	if(msg.addr != nullptr) {
+		releaseAddrBuffer(msg.addr);
+	}
+}
+
+Node::vector* MessageBus::acquireAddrBuffer()
+{
+	if(freeAddrBuffers.empty()) {
+		addrBuffers.emplace_back(new Node::vector());
+		return addrBuffers.back().get();
+	}
+	Node::vector* buffer = freeAddrBuffers.back();
+	freeAddrBuffers.pop_back();
+	return buffer;
+}
+
+void MessageBus::setShardContext(std::shared_ptr<ShardContext> shard)
+{
+	this->shard = shard;
+}
+
+unsigned long MessageBus::getPosted(Message::Type type) const
+{
+	return posted[type];
+}
+
+unsigned long MessageBus::getPostedAddrs() const
+{
+	return postedAddrs;
+}
+
+void MessageBus::releaseAddrBuffer(Node::vector* buffer)
+{
+	// clear() keeps the capacity, so the buffer won't allocate again
+	buffer->clear();
+	freeAddrBuffers.push_back(buffer);
+}
@@ -0,0 +1,94 @@
+/*!
+ * \brief The message bus which carries the protocol messages between Nodes
+ */
+
+#ifndef MESSAGE_H
+#define MESSAGE_H
+
+#include "node.h"
+#include <vector>
+#include <memory>
+
+class ShardContext;
+
+/*!
+ * \brief Represents a protocol message in flight.
+ */
+typedef struct Message {
+	/*!
+	 * \brief the protocol message types carried by the bus
+	 */
+	enum Type {
+		VERSION, //!< a "version" message
+		GETADDR, //!< a "getaddr" message
+		ADDR //!< an "addr" message, carrying a pooled payload
+	};
+
+	Type type; //!< the type of this message
+	Node::ptr sender; //!< the Node which sent the message
+	Node::ptr receiver; //!< the Node the message will be delivered to
+	Node::vector* addr; //!< the pooled payload of "addr" messages, nullptr for other types
+} Message;
+
+/*!
+ * \brief Collects the messages sent during a tick and delivers them in one batch.
+ *
+ * The payloads of "addr" messages are taken from a pool of recycled buffers, so
+ * they keep their capacity between ticks instead of being allocated per message.
+ */
+class MessageBus
+{
+public:
+	typedef std::shared_ptr<MessageBus> ptr; //!< a shared_ptr of type MessageBus.
+
+	MessageBus();
+	~MessageBus();
+
+	/*!
+	 * \brief queues a message for delivery at the end of the current tick
+	 * \param type is the type of the message.
+	 * \param sender is the Node the message is sent from.
+	 * \param receiver is the Node the message will be delivered to.
+	 * \param addr is the payload of an "addr" message, the bus takes ownership of it.
+	 */
+	void post(Message::Type type, const Node::ptr& sender, const Node::ptr& receiver, Node::vector* addr = nullptr);
+
+	/*!
+	 * \brief delivers all queued messages, including the ones which are sent while delivering
+	 */
+	void deliver();
+
+	/*!
+	 * \brief takes an empty payload buffer out of the pool
+	 * \return an empty buffer, which has to be handed back via post() or releaseAddrBuffer()
+	 */
+	Node::vector* acquireAddrBuffer();
+
+	/*!
+	 * \brief hands a payload buffer back to the pool
+	 * \param buffer is the buffer to recycle
+	 */
+	void releaseAddrBuffer(Node::vector* buffer);
+
+	/*!
+	 * \brief routes messages to Nodes of other shards through the given context
+	 * \param shard is the shard context of this worker
+	 */
+	void setShardContext(std::shared_ptr<ShardContext> shard);
+
+	unsigned long getPosted(Message::Type type) const; //!< returns the messages of a type posted so far
+	unsigned long getPostedAddrs() const; //!< returns the addresses carried by all "addr" messages posted so far
+
+private:
+	void dispatch(Message& msg); //!< hands a message to its receiver
+
+	std::vector<Message> queue; //!< messages waiting for delivery
+	std::vector<Message> batch; //!< the batch of messages currently being delivered
+	std::vector<std::unique_ptr<Node::vector>> addrBuffers; //!< all payload buffers ever created, owned by the pool
+	std::vector<Node::vector*> freeAddrBuffers; //!< payload buffers which are ready to be reused
+	std::shared_ptr<ShardContext> shard; //!< the shard context in a sharded simulation, else nullptr
+	unsigned long posted[3]; //!< the messages posted so far, indexed by Message::Type
+	unsigned long postedAddrs; //!< the addresses of all "addr" messages posted so far
+};
+
+#endif // MESSAGE_H
@@ -0,0 +1,258 @@
+#include "metrics.h"
+#include <algorithm>
+#include <atomic>
+#include <sstream>
+#include <thread>
+
+bool parseMetrics(const std::string& list, unsigned int& metrics)
+{
+	metrics = 0;
+	std::istringstream stream(list);
+	std::string name;
+	while(std::getline(stream, name, ',')) {
+		if(name == "betweenness") metrics |= BETWEENNESS;
+		else if(name == "kcore") metrics |= KCORE;
+		else if(name == "degree") metrics |= DEGREE;
+		else if(name == "assortativity") metrics |= ASSORTATIVITY;
+		else if(name == "components") metrics |= COMPONENTS;
+		else if(name == "all") metrics |= ALLMETRICS;
+		else return false;
+	}
+	return true;
+}
+
+MetricsEngine::MetricsEngine(unsigned int threads) : threads(threads)
+{
+	if(this->threads == 0) {
+		this->threads = std::max(1u, std::thread::hardware_concurrency());
+	}
+}
+
+unsigned int MetricsEngine::getThreads()
+{
+	return threads;
+}
+
+GraphMetrics MetricsEngine::calculate(const CSRGraph& g, unsigned int metrics)
+{
+	GraphMetrics result;
+
+	// the linear-time metrics write disjoint fields, so they can run side by side
+	std::vector<std::thread> tasks;
+	if(metrics & KCORE) tasks.emplace_back(&MetricsEngine::calculateKCore, this, std::cref(g), std::ref(result));
+	if(metrics & DEGREE) tasks.emplace_back(&MetricsEngine::calculateDegrees, this, std::cref(g), std::ref(result));
+	if(metrics & ASSORTATIVITY) tasks.emplace_back(&MetricsEngine::calculateAssortativity, this, std::cref(g), std::ref(result));
+	if(metrics & COMPONENTS) tasks.emplace_back(&MetricsEngine::calculateComponents, this, std::cref(g), std::ref(result));
+	for(std::thread& t : tasks) {
+		t.join();
+	}
+
+	if(metrics & BETWEENNESS) calculateBetweenness(g, result);
+	return result;
+}
+
+void MetricsEngine::calculateBetweenness(const CSRGraph& g, GraphMetrics& result)
+{
+	uint32_t n = g.numVertices();
+	std::vector<std::vector<double>> partial(threads);
+	std::atomic<uint32_t> nextSource(0);
+
+	auto worker = [&](unsigned int id) {
+		// per thread state, reused by every traversal
+		std::vector<double>& centrality = partial[id];
+		centrality.assign(n, 0);
+		std::vector<uint32_t> distance(n, UINT32_MAX);
+		std::vector<double> sigma(n, 0);
+		std::vector<double> delta(n, 0);
+		std::vector<uint32_t> order(n);
+
+		//! \constraint sources are handed out one by one, the traversals differ a lot in cost
+		for(uint32_t source = nextSource++; source < n; source = nextSource++) {
+			distance[source] = 0;
+			sigma[source] = 1;
+			order[0] = source;
+			uint32_t head = 0, tail = 1;
+			while(head < tail) {
+				uint32_t u = order[head++];
+				for(const uint32_t* it = g.neighborsBegin(u); it != g.neighborsEnd(u); ++it) {
+					if(distance[*it] == UINT32_MAX) {
+						distance[*it] = distance[u] + 1;
+						order[tail++] = *it;
+					}
+					if(distance[*it] == distance[u] + 1) {
+						sigma[*it] += sigma[u];
+					}
+				}
+			}
+
+			// accumulate the dependencies in reverse BFS order, the predecessors are found again by distance
+			for(uint32_t i = tail; i-- > 1;) {
+				uint32_t w = order[i];
+				for(const uint32_t* it = g.neighborsBegin(w); it != g.neighborsEnd(w); ++it) {
+					if(distance[*it] + 1 == distance[w]) {
+						delta[*it] += sigma[*it] / sigma[w] * (1 + delta[w]);
+					}
+				}
+				centrality[w] += delta[w];
+			}
+
+			for(uint32_t i = 0; i < tail; ++i) {
+				distance[order[i]] = UINT32_MAX;
+				sigma[order[i]] = 0;
+				delta[order[i]] = 0;
+			}
+		}
+	};
+
+	std::vector<std::thread> workers;
+	for(unsigned int id = 1; id < threads; ++id) {
+		workers.emplace_back(worker, id);
+	}
+	worker(0);
+	for(std::thread& t : workers) {
+		t.join();
+	}
+
+	// every pair was counted from both of its ends
+	result.betweenness.assign(n, 0);
+	result.maxBetweenness = 0;
+	double sum = 0;
+	for(uint32_t v = 0; v < n; ++v) {
+		for(unsigned int id = 0; id < threads; ++id) {
+			result.betweenness[v] += partial[id][v];
+		}
+		result.betweenness[v] /= 2;
+		result.maxBetweenness = std::max(result.maxBetweenness, result.betweenness[v]);
+		sum += result.betweenness[v];
+	}
+	result.meanBetweenness = n > 0 ? sum / n : 0;
+}
+
+void MetricsEngine::calculateKCore(const CSRGraph& g, GraphMetrics& result)
+{
+	uint32_t n = g.numVertices();
+	uint32_t maxDegree = 0;
+	std::vector<uint32_t> degree(n);
+	for(uint32_t v = 0; v < n; ++v) {
+		degree[v] = g.degree(v);
+		maxDegree = std::max(maxDegree, degree[v]);
+	}
+
+	// sort the vertices by degree with a counting sort
+	std::vector<uint32_t> binStart(maxDegree + 2, 0);
+	for(uint32_t v = 0; v < n; ++v) {
+		binStart[degree[v] + 1]++;
+	}
+	for(uint32_t d = 1; d < binStart.size(); ++d) {
+		binStart[d] += binStart[d - 1];
+	}
+	std::vector<uint32_t> vertices(n), position(n);
+	std::vector<uint32_t> next(binStart.begin(), binStart.end() - 1);
+	for(uint32_t v = 0; v < n; ++v) {
+		position[v] = next[degree[v]]++;
+		vertices[position[v]] = v;
+	}
+
+	// peel the vertex of lowest degree, its neighbors move one bin down
+	for(uint32_t i = 0; i < n; ++i) {
+		uint32_t v = vertices[i];
+		for(const uint32_t* it = g.neighborsBegin(v); it != g.neighborsEnd(v); ++it) {
+			uint32_t u = *it;
+			if(degree[u] > degree[v]) {
+				uint32_t du = degree[u];
+				uint32_t pu = position[u];
+				uint32_t pw = binStart[du];
+				uint32_t w = vertices[pw];
+				if(u != w) {
+					vertices[pu] = w;
+					position[w] = pu;
+					vertices[pw] = u;
+					position[u] = pw;
+				}
+				binStart[du]++;
+				degree[u]--;
+			}
+		}
+	}
+
+	result.coreness = degree;
+	result.degeneracy = 0;
+	for(uint32_t core : degree) {
+		result.degeneracy = std::max(result.degeneracy, core);
+	}
+	result.coreSizes.assign(result.degeneracy + 1, 0);
+	for(uint32_t core : degree) {
+		result.coreSizes[core]++;
+	}
+}
+
+void MetricsEngine::calculateDegrees(const CSRGraph& g, GraphMetrics& result)
+{
+	uint32_t n = g.numVertices();
+	result.maxDegree = 0;
+	for(uint32_t v = 0; v < n; ++v) {
+		result.maxDegree = std::max(result.maxDegree, g.degree(v));
+	}
+	result.degrees.assign(result.maxDegree + 1, 0);
+	for(uint32_t v = 0; v < n; ++v) {
+		result.degrees[g.degree(v)]++;
+	}
+	result.meanDegree = n > 0 ? 2.0 * g.numEdges() / n : 0;
+}
+
+void MetricsEngine::calculateAssortativity(const CSRGraph& g, GraphMetrics& result)
+{
+	// Newman (2002), summed over both directions of every edge
+	uint32_t n = g.numVertices();
+	double sumProduct = 0, sumDegree = 0, sumSquares = 0;
+	uint64_t ends = 0;
+	for(uint32_t v = 0; v < n; ++v) {
+		double dv = g.degree(v);
+		for(const uint32_t* it = g.neighborsBegin(v); it != g.neighborsEnd(v); ++it) {
+			double du = g.degree(*it);
+			sumProduct += dv * du;
+			sumDegree += dv;
+			sumSquares += dv * dv;
+			ends++;
+		}
+	}
+
+	result.assortativity = 0;
+	if(ends == 0) return;
+	double mean = sumDegree / ends;
+	double variance = sumSquares / ends - mean * mean;
+	//! \constraint regular graphs have no degree variance, their assortativity is reported as 0
+	if(variance > 0) {
+		result.assortativity = (sumProduct / ends - mean * mean) / variance;
+	}
+}
+
+void MetricsEngine::calculateComponents(const CSRGraph& g, GraphMetrics& result)
+{
+	uint32_t n = g.numVertices();
+	std::vector<bool> visited(n, false);
+	std::vector<uint32_t> queue(n);
+	result.components = 0;
+	result.largestComponent = 0;
+	result.isolatedVertices = 0;
+
+	for(uint32_t root = 0; root < n; ++root) {
+		if(visited[root]) continue;
+		if(g.degree(root) == 0) result.isolatedVertices++;
+
+		visited[root] = true;
+		queue[0] = root;
+		uint32_t head = 0, tail = 1;
+		while(head < tail) {
+			uint32_t u = queue[head++];
+			for(const uint32_t* it = g.neighborsBegin(u); it != g.neighborsEnd(u); ++it) {
+				if(!visited[*it]) {
+					visited[*it] = true;
+					queue[tail++] = *it;
+				}
+			}
+		}
+		result.components++;
+		result.largestComponent = std::max(result.largestComponent, tail);
+	}
+}
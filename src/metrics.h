@@ -0,0 +1,95 @@
+/*!
+ * \brief The structure metrics of a graph, calculated in parallel
+ */
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include "csrgraph.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*!
+ * \brief The metrics which can be selected for the analysis, combined as a bit mask
+ */
+enum Metric : unsigned int {
+	BETWEENNESS = 1 << 0, //!< Brandes betweenness centrality
+	KCORE = 1 << 1, //!< k-core decomposition
+	DEGREE = 1 << 2, //!< degree distribution
+	ASSORTATIVITY = 1 << 3, //!< degree assortativity
+	COMPONENTS = 1 << 4, //!< connected components
+	ALLMETRICS = (1 << 5) - 1 //!< all of the above
+};
+
+/*!
+ * \brief parses a comma separated list of metric names, e.g. "kcore,degree" or "all"
+ * \param list is the list to parse.
+ * \param metrics will hold the selected metrics.
+ * \return false if the list contains an unknown name
+ */
+bool parseMetrics(const std::string& list, unsigned int& metrics);
+
+/*!
+ * \brief The results of the selected metrics of one graph.
+ *
+ * Only the fields of the selected metrics are filled in.
+ */
+typedef struct GraphMetrics {
+	std::vector<double> betweenness; //!< the (undirected) betweenness centrality of every vertex
+	double maxBetweenness = 0; //!< the highest betweenness centrality
+	double meanBetweenness = 0; //!< the mean betweenness centrality
+
+	std::vector<uint32_t> coreness; //!< the core number of every vertex
+	uint32_t degeneracy = 0; //!< the highest core number
+	std::vector<uint64_t> coreSizes; //!< number of vertices per core number
+
+	std::vector<uint64_t> degrees; //!< number of vertices per degree
+	uint32_t maxDegree = 0; //!< the highest degree
+	double meanDegree = 0; //!< the mean degree
+
+	double assortativity = 0; //!< the Pearson correlation of the degrees at both ends of the edges
+
+	uint32_t components = 0; //!< number of connected components
+	uint32_t largestComponent = 0; //!< number of vertices in the largest component
+	uint32_t isolatedVertices = 0; //!< number of vertices without any edge
+} GraphMetrics;
+
+/*!
+ * \brief Calculates the structure metrics of a CSRGraph.
+ *
+ * The linear-time metrics run as concurrent tasks, the betweenness centrality,
+ * which needs one traversal per vertex, is split across all threads by source vertex.
+ */
+class MetricsEngine
+{
+public:
+	/*!
+	 * \param threads is the number of threads to use, 0 uses one per hardware thread.
+	 */
+	MetricsEngine(unsigned int threads = 0);
+
+	/*!
+	 * \brief calculates the selected metrics
+	 * \param g is the graph to analyze.
+	 * \param metrics is a bit mask of Metric values.
+	 * \return the results of the selected metrics
+	 */
+	GraphMetrics calculate(const CSRGraph& g, unsigned int metrics);
+
+	/*!
+	 * \brief returns the number of threads used
+	 */
+	unsigned int getThreads();
+
+private:
+	void calculateBetweenness(const CSRGraph& g, GraphMetrics& result); //!< Brandes' algorithm, one source per task
+	void calculateKCore(const CSRGraph& g, GraphMetrics& result); //!< Batagelj-Zaversnik bucket peeling
+	void calculateDegrees(const CSRGraph& g, GraphMetrics& result); //!< degree histogram
+	void calculateAssortativity(const CSRGraph& g, GraphMetrics& result); //!< Newman's degree correlation
+	void calculateComponents(const CSRGraph& g, GraphMetrics& result); //!< breadth-first labelling
+
+	unsigned int threads; //!< number of worker threads
+};
+
+#endif // METRICS_H
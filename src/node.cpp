@@ -1,59 +1,91 @@
 #include "node.h"
 #include "constants.h"
 #include "bittopsim.h"
+#include "message.h"
 #include <iostream>
 #include <cstring>
 #include <arpa/inet.h>
 #include <cassert>
+#include <algorithm>
 
-Node::Node(Simulation *simCTX, bool acceptInboundConnections, bool online) : simCTX(simCTX), acceptInboundConnections(acceptInboundConnections), online(online), identifier(generateRandomIP()), nOutboundConnections(0), nInboundConnections(0), sendAddrNodesLastFill(0) {}
+Node::Node(Simulation *simCTX, Role role, bool online) : simCTX(simCTX), role(role), online(online), maintenanceRequested(false), nOutboundConnections(0), sendAddrNodesLastFill(0), maintenanceBackoff(1), nextWakeUp(0), identifier(generateRandomIP()), index(NOINDEX) {}
 
 Node::~Node() {}
 
-bool Node::inboundConnect(Node::ptr originNode) 
+template<typename RolePolicy>
+RoleNode<RolePolicy>::RoleNode(Simulation* simCTX, bool online) : Node(simCTX, RolePolicy::role, online) {}
+
+template<typename RolePolicy>
+bool RoleNode<RolePolicy>::inboundConnect(const Node::ptr& originNode) 
 {
-	if(!acceptInboundConnections) return false;
+	if(!RolePolicy::acceptInboundConnections) return false;
 	if(*originNode == *this) return false;
 
 	if(originNode->isReachable()) {
 		addKnownNode(originNode);
 	}
 
-	if(nOutboundConnections + nInboundConnections >= MAXCONNECTEDPEERS) return false;
+	if(nOutboundConnections + inbound().size() >= MAXCONNECTEDPEERS) return false;
 
 	if(!nodeInVector(originNode, connections)) {
-		//LOG("\tNode " << std::setw(15) << getID() << std::setw(10) << " <-- " << std::setw(15) << originNode->getID() << " [" << nOutboundConnections << "/" << MAXOUTBOUNDPEERS << " out | " << nInboundConnections << " in ]"); 
+		//LOG("\tNode " << std::setw(15) << getID() << std::setw(10) << " <-- " << std::setw(15) << originNode->getID() << " [" << nOutboundConnections << "/" << MAXOUTBOUNDPEERS << " out | " << inbound().size() << " in ]"); 
 		connections.push_back(originNode);
-		inboundConnections.push_back(originNode);
-		nInboundConnections++;
+		addrOutbox.push_back(nullptr);
+		addrKnown.emplace_back();
+		inbound().add(originNode);
+		simCTX->connectionOpened(shared_from_this(), originNode);
 
-		assert(inboundConnections.size() == nInboundConnections);
-		assert(connections.size() == nOutboundConnections + nInboundConnections);
+		assert(connections.size() == nOutboundConnections + inbound().size());
 	}
 
 	return true;
 }
 
 
-void Node::inboundDisconnect(Node::ptr originNode)
+template<typename RolePolicy>
+void RoleNode<RolePolicy>::inboundDisconnect(const Node::ptr& originNode)
 {
 	auto it = findNodeInVector(originNode, connections);
 	if(it != std::end(connections)) {
-		connections.erase(it);
-		auto iit = findNodeInVector(originNode, inboundConnections);
-		if(iit != std::end(inboundConnections)) {
-			inboundConnections.erase(iit);
-			nInboundConnections--;
-		} else {
+		eraseConnection(std::distance(std::begin(connections), it));
+		if(!inbound().remove(originNode)) {
 			nOutboundConnections--;
+			// we lost an outbound peer, replace it
+			requestMaintenance();
 		}
 	}
-	assert(inboundConnections.size() == nInboundConnections);
-	assert(connections.size() == nOutboundConnections + nInboundConnections);
+	assert(connections.size() == nOutboundConnections + inbound().size());
+}
+
+template<typename RolePolicy>
+void RoleNode<RolePolicy>::connectionRejected(const Node::ptr& destNode)
+{
+	// only an outbound connection can be rejected
+	auto it = findNodeInVector(destNode, connections);
+	if(it == std::end(connections) || inbound().contains(destNode)) return;
+
+	eraseConnection(std::distance(std::begin(connections), it));
+	nOutboundConnections--;
+	requestMaintenance();
+
+	assert(connections.size() == nOutboundConnections + inbound().size());
+}
+
+void Node::mirrorState(bool online)
+{
+	this->online = online;
+	if(online) {
+		simCTX->setNodeOnline(shared_from_this());
+	} else {
+		simCTX->setNodeOffline(shared_from_this());
+	}
 }
 
-bool Node::connect(Node::ptr destNode, bool fOneShot)
+template<typename RolePolicy>
+bool RoleNode<RolePolicy>::connect(const Node::ptr& destNode, bool fOneShot)
 {
+	fOneShot = fOneShot || RolePolicy::oneShotConnections;
+
 	// we can't reach the receiver
 	if(!destNode->isReachable()) return false;
 
@@ -61,22 +93,30 @@ bool Node::connect(Node::ptr destNode, bool fOneShot)
 	if (*destNode == *this) return false;
 
 	// don't connect if we have enough peers
-	if(nOutboundConnections >= MAXOUTBOUNDPEERS || nOutboundConnections + nInboundConnections >= MAXCONNECTEDPEERS) return false;
+	if(nOutboundConnections >= simCTX->getMaxOutbound() || nOutboundConnections + inbound().size() >= MAXCONNECTEDPEERS) return false;
 
 	// don't connect to already connected Node...
 	if (nodeInVector(destNode, connections)) return true;
 	
-	// establish connection
-	bool connection = destNode->inboundConnect(shared_from_this());
+	// establish connection, connections to other shards are confirmed one window later
+	bool connection;
+	if(simCTX->isLocalNode(destNode)) {
+		connection = destNode->inboundConnect(shared_from_this());
+	} else {
+		connection = simCTX->getShardContext()->connect(shared_from_this(), destNode);
+	}
 
 	if(connection) {
 		connections.push_back(destNode);
+		addrOutbox.push_back(nullptr);
+		addrKnown.emplace_back();
 		nOutboundConnections++;
+		simCTX->connectionOpened(shared_from_this(), destNode);
 
 		// disabling output for fOneShot-connections for now
-		//LOG("\tNode " << std::setw(15) << getID() << std::setw(10) << " --> " << std::setw(15) << destNode->getID() << " [" << nOutboundConnections << "/" << MAXOUTBOUNDPEERS << " out | " << nInboundConnections << " in ] - fOneShot: " << std::boolalpha << fOneShot);
+		//LOG("\tNode " << std::setw(15) << getID() << std::setw(10) << " --> " << std::setw(15) << destNode->getID() << " [" << nOutboundConnections << "/" << MAXOUTBOUNDPEERS << " out | " << inbound().size() << " in ] - fOneShot: " << std::boolalpha << fOneShot);
 		if(!fOneShot) {
-			LOG("\tNode " << std::setw(15) << getID() << std::setw(10) << " --> " << std::setw(15) << destNode->getID() << " [" << nOutboundConnections << "/" << MAXOUTBOUNDPEERS << " out | " << nInboundConnections << " in ]");
+			LOG("\tNode " << std::setw(15) << getID() << std::setw(10) << " --> " << std::setw(15) << destNode->getID() << " [" << nOutboundConnections << "/" << simCTX->getMaxOutbound() << " out | " << inbound().size() << " in ]");
 		}
 
 		if (fOneShot) {
@@ -86,57 +126,55 @@ bool Node::connect(Node::ptr destNode, bool fOneShot)
 
 	}
 
-	assert(inboundConnections.size() == nInboundConnections);
-	assert(connections.size() == nOutboundConnections + nInboundConnections);
+	assert(connections.size() == nOutboundConnections + inbound().size());
 	return connection;
 }
 
 
-void Node::disconnect(Node::ptr destNode)
+template<typename RolePolicy>
+void RoleNode<RolePolicy>::disconnect(const Node::ptr& destNode)
 {
-	destNode->inboundDisconnect(shared_from_this());
+	if(simCTX->isLocalNode(destNode)) {
+		destNode->inboundDisconnect(shared_from_this());
+	} else {
+		simCTX->getShardContext()->disconnect(shared_from_this(), destNode);
+	}
 
 	auto it = findNodeInVector(destNode, connections);
 	if (it != std::end(connections)) {
-		connections.erase(it);
+		eraseConnection(std::distance(std::begin(connections), it));
 
-		auto iit = findNodeInVector(destNode, inboundConnections);
-		if (iit != std::end(inboundConnections)) {
-			nInboundConnections--;
-			inboundConnections.erase(iit);
-		} else {
+		if (!inbound().remove(destNode)) {
 			nOutboundConnections--;
 		}
 	}
 
-	assert(inboundConnections.size() == nInboundConnections);
-	assert(connections.size() == nOutboundConnections + nInboundConnections);
+	assert(connections.size() == nOutboundConnections + inbound().size());
 }
 
-void Node::sendVersionMsg(Node::ptr receiverNode)
+void Node::sendVersionMsg(const Node::ptr& receiverNode)
 {
-	receiverNode -> recvVersionMsg(shared_from_this());
+	simCTX->getMessageBus()->post(Message::VERSION, shared_from_this(), receiverNode);
 }
 
-void Node::recvVersionMsg(Node::ptr senderNode)
+template<typename RolePolicy>
+void RoleNode<RolePolicy>::recvVersionMsg(const Node::ptr& senderNode)
 {
-	if(nodeInVector(senderNode, inboundConnections)) {
+	if(inbound().contains(senderNode)) {
 		sendVersionMsg(senderNode);
 		if(senderNode->isReachable()) {
 			addKnownNode(senderNode);
 		}
 	} else {
 		// advertise if we accept connections
-		if(acceptInboundConnections) {
-			Node::vector addr;
-			addr.push_back(shared_from_this());
-			scheduleAddrMsg(senderNode, addr);
+		if(RolePolicy::acceptInboundConnections) {
+			scheduleAddrMsg(senderNode, shared_from_this());
 		}
 		sendGetaddrMsg(senderNode);
 	}
 }
 
-void Node::addKnownNode(Node::ptr node)
+void Node::addKnownNode(const Node::ptr& node)
 {
 	// don't add unreachable nodes
 	if (!node->isReachable()) return;
@@ -147,54 +185,149 @@ void Node::addKnownNode(Node::ptr node)
 	auto it = knownNodes.find(node->getID());
 	if(it == knownNodes.end()) {
 		knownNodes[node->getID()] = node;
+		simCTX->knownNodeAdded(*this, *node);
+
+		// a new peer to try, if we're still below our outbound target
+		if(nOutboundConnections < simCTX->getMaxOutbound() && !maintenanceRequested) {
+			maintenanceBackoff = 1;
+			requestMaintenance();
+		}
+	}
+}
+
+void Node::restoreKnownNodes(const Node::vector& nodes)
+{
+	for(const Node::ptr& node : nodes) {
+		if(*node != *this) {
+			knownNodes[node->getID()] = node;
+			simCTX->knownNodeAdded(*this, *node);
+		}
+	}
+}
+
+Node::vector Node::getKnownNodes()
+{
+	Node::vector nodes;
+	nodes.reserve(knownNodes.size());
+	for(auto& known : knownNodes) {
+		nodes.push_back(known.second);
 	}
+	return nodes;
 }
 
-void Node::addKnownNodes(Node::vector& nodes)
+void Node::addKnownNodes(const Node::vector& nodes)
 {
-	for (Node::ptr n : nodes) {
+	for (const Node::ptr& n : nodes) {
 		if(n->isReachable()) {
 			addKnownNode(n);
 		}
 	}
 }
 
-void Node::removeKnownNode(Node::ptr node)
+void Node::removeKnownNode(const Node::ptr& node)
 {
 	// if node is in known Nodes, remove it
 	auto it = knownNodes.find(node->getID());
 	if ( it != knownNodes.end()) {
+		simCTX->knownNodeRemoved(*this, *it->second);
 		knownNodes.erase(it);
 	}
 }
 
-void Node::scheduleAddrMsg(Node::ptr receiverNode, Node::vector& vAddr)
+void Node::scheduleAddrMsg(const Node::ptr& receiverNode, Node::vector& vAddr)
 {
-	Node::vector& element = addrMessagesToSend[receiverNode->getID()];
-	for(Node::ptr addr : vAddr) {
-		if(!nodeInVector(addr, element)) {
-			element.push_back(addr);
-		}
+	//! \constraint addrs can only be sent over an open connection, addrs for other nodes are dropped
+	unsigned int slot = connectionSlot(receiverNode);
+	if(slot == connections.size()) return;
+	for(const Node::ptr& addr : vAddr) {
+		pushAddr(slot, addr);
 	}
 }
 
-void Node::scheduleDisconnect(Node::ptr node) {
+void Node::scheduleAddrMsg(const Node::ptr& receiverNode, const Node::ptr& addr)
+{
+	unsigned int slot = connectionSlot(receiverNode);
+	if(slot == connections.size()) return;
+	pushAddr(slot, addr);
+}
+
+unsigned int Node::connectionSlot(const Node::ptr& node)
+{
+	return std::distance(std::begin(connections), findNodeInVector(node, connections));
+}
+
+RollingBloomFilter* Node::addrKnownOf(unsigned int slot)
+{
+	//! \constraint the one-shot connections of the crawler only last a tick, there is nothing to remember for them
+	if(index == NOINDEX || connections[slot]->getIndex() == NOINDEX) return nullptr;
+
+	RollingBloomFilter::ptr& known = addrKnown.at(slot);
+	if(known == nullptr) {
+		// every filter hashes differently, so the false positives of the peers don't coincide
+		uint32_t tweak = index * 0x9E3779B9u ^ connections[slot]->getIndex();
+		known.reset(new RollingBloomFilter(ADDRKNOWNELEMENTS, ADDRKNOWNFPRATE, tweak));
+		// the peer knows itself
+		known->insert(connections[slot]->getIndex());
+	}
+	return known.get();
+}
+
+void Node::pushAddr(unsigned int slot, const Node::ptr& addr)
+{
+	//! \constraint like Bitcoin's m_addr_known, the filter is keyed by the population index, only population nodes are relayed
+	RollingBloomFilter* known = addrKnownOf(slot);
+	if(known != nullptr) {
+		if(known->contains(addr->getIndex())) return;
+		known->insert(addr->getIndex());
+	} else if(addrOutbox[slot] != nullptr && nodeInVector(addr, *addrOutbox[slot])) {
+		return;
+	}
+
+	Node::vector*& outbox = addrOutbox[slot];
+	if(outbox == nullptr) {
+		outbox = simCTX->getMessageBus()->acquireAddrBuffer();
+		requestMaintenance();
+	}
+	outbox->push_back(addr);
+}
+
+void Node::eraseConnection(unsigned int slot)
+{
+	if(addrOutbox.at(slot) != nullptr) {
+		simCTX->getMessageBus()->releaseAddrBuffer(addrOutbox.at(slot));
+	}
+	simCTX->connectionClosed(shared_from_this(), connections.at(slot));
+	addrOutbox.erase(std::begin(addrOutbox) + slot);
+	addrKnown.erase(std::begin(addrKnown) + slot);
+	connections.erase(std::begin(connections) + slot);
+}
+
+void Node::scheduleDisconnect(const Node::ptr& node) {
 	if(!nodeInVector(node, disconnectSchedule)) {
 		disconnectSchedule.push_back(node);
+		requestMaintenance();
 	}
 }
 
-void Node::sendAddrMsg(Node::ptr receiverNode, Node::vector& vAddr) 
+void Node::sendAddrMsg(const Node::ptr& receiverNode, Node::vector* vAddr) 
 {
-
-	receiverNode->recvAddrMsg(shared_from_this(), vAddr);
+	simCTX->getMessageBus()->post(Message::ADDR, shared_from_this(), receiverNode, vAddr);
 }
 
-void Node::recvAddrMsg(Node::ptr originNode, Node::vector& vAddr)
+void Node::recvAddrMsg(const Node::ptr& originNode, Node::vector& vAddr)
 {
 	//! \constraint We don't check whether a node is in reachable nets, and hence are always forwarding the "addr" messages to two nodes.
 	addKnownNodes(vAddr);
 
+	// the sender knows what it sent, so these addrs are never sent back to it
+	unsigned int slot = connectionSlot(originNode);
+	RollingBloomFilter* known = slot < connections.size() ? addrKnownOf(slot) : nullptr;
+	if(known != nullptr) {
+		for(const Node::ptr& addr : vAddr) {
+			known->insert(addr->getIndex());
+		}
+	}
+
 	
 	unsigned long now = Simulation::getSimClock();
 
@@ -228,7 +361,7 @@ void Node::recvAddrMsg(Node::ptr originNode, Node::vector& vAddr)
 
 	// relay to the other nodes
 	if(!nodeInVector(originNode, relayedAddrFrom) && vAddr.size() <= 10) {
-		for(Node::ptr n : sendAddrNodes) {
+		for(const Node::ptr& n : sendAddrNodes) {
 			//! \constraint We schedule here, instead of sending directly to avoid a infinite loop
 			scheduleAddrMsg(n, vAddr);
 		}
@@ -243,23 +376,39 @@ void Node::recvAddrMsg(Node::ptr originNode, Node::vector& vAddr)
 
 }
 
-void Node::sendGetaddrMsg(Node::ptr receiverNode)
+void Node::sendGetaddrMsg(const Node::ptr& receiverNode)
 {
 	relayedAddrFrom.push_back(receiverNode);
-	receiverNode->recvGetaddrMsg(shared_from_this());
+	simCTX->getMessageBus()->post(Message::GETADDR, shared_from_this(), receiverNode);
 }
 
-void Node::recvGetaddrMsg(Node::ptr senderNode) {
-	Node::vector result;
+void Node::recvGetaddrMsg(const Node::ptr& senderNode) {
+	Node::vector* result = simCTX->getMessageBus()->acquireAddrBuffer();
 	int max = 0.23 * knownNodes.size() < 2500 ? 0.23 * knownNodes.size() : 2500; // return 2500 addresses at maximum, else 23% of knownNodes
 	//! \constraint but still, only send 1000 addrs at max
 	max =  max < 1000 ? max : 1000;
 	for (int i = 0; i < max; ++i) {
 		Node::ptr n = randomNodeOfMap(knownNodes);
-		while(nodeInVector(n, result)) {
+		while(nodeInVector(n, *result)) {
 			n = randomNodeOfMap(knownNodes);
 		}
-		result.push_back(n);
+		result->push_back(n);
+	}
+
+	// like any addr, the reply leaves out what the sender already knows
+	unsigned int slot = connectionSlot(senderNode);
+	RollingBloomFilter* known = slot < connections.size() ? addrKnownOf(slot) : nullptr;
+	if(known != nullptr) {
+		auto unknown = std::remove_if(std::begin(*result), std::end(*result), [known](const Node::ptr& addr) {
+			if(known->contains(addr->getIndex())) return true;
+			known->insert(addr->getIndex());
+			return false;
+		});
+		result->erase(unknown, std::end(*result));
+	}
+	if(result->empty()) {
+		simCTX->getMessageBus()->releaseAddrBuffer(result);
+		return;
 	}
 	sendAddrMsg(senderNode, result);
 }
@@ -269,11 +418,23 @@ std::string Node::getID() const
 	return identifier;
 }
 
+unsigned long Node::getIndex() const
+{
+	return index;
+}
+
+void Node::setIndex(unsigned long index)
+{
+	this->index = index;
+}
+
 void Node::start()
 {
 	LOG("Starting Node " << getID() << ".");
 	online = true;
 	simCTX->setNodeOnline(shared_from_this());
+	maintenanceBackoff = 1;
+	requestMaintenance();
 	fillConnections();
 
 	if(connections.size() >= 2) {
@@ -283,45 +444,134 @@ void Node::start()
 	DNSSeeder::ptr seed = simCTX->getDNSSeeder();
 	connect(seed->getCrawlerNode(), true);
 
-	Node::vector nodesFromSeeds = seed->queryDNS();
-	addKnownNodes(nodesFromSeeds);
+	addKnownNodes(seed->queryDNS());
 	fillConnections();
 }
 
-void Node::stop() 
+void Node::warmStart()
+{
+	LOG("Warm starting Node " << getID() << ".");
+	online = true;
+	simCTX->setNodeOnline(shared_from_this());
+	maintenanceBackoff = 1;
+}
+
+bool Node::restoreConnection(const Node::ptr& destNode)
+{
+	if(!online || !destNode->isReachable() || *destNode == *this) return false;
+	if(nOutboundConnections >= simCTX->getMaxOutbound() || connections.size() >= MAXCONNECTEDPEERS) return false;
+	if(nodeInVector(destNode, connections)) return false;
+
+	//! \constraint restored connections are established at once, the peers already exchanged their addrs
+	if(!destNode->inboundConnect(shared_from_this())) return false;
+
+	connections.push_back(destNode);
+	addrOutbox.push_back(nullptr);
+	addrKnown.emplace_back();
+	nOutboundConnections++;
+	simCTX->connectionOpened(shared_from_this(), destNode);
+	addKnownNode(destNode);
+	return true;
+}
+
+template<typename RolePolicy>
+void RoleNode<RolePolicy>::stop() 
 {
 	LOG("Stopping Node " << getID() << ".");
 	online = false;
 	simCTX->setNodeOffline(shared_from_this());
 
-	Node::vector copyConn = connections;
-	for(Node::ptr n : copyConn) {
+	Node::scratch_vector copyConn(std::begin(connections), std::end(connections), *simCTX->getScratchArena());
+	for(const Node::ptr& n : copyConn) {
 		disconnect(n);
 	}
 
 	// reset to make sure we dont have connections anymore
 	nOutboundConnections = 0;
-	nInboundConnections = 0;
+	for(Node::vector* outbox : addrOutbox) {
+		if(outbox != nullptr) {
+			simCTX->getMessageBus()->releaseAddrBuffer(outbox);
+		}
+	}
+	addrOutbox.clear();
+	addrKnown.clear();
 	connections.clear();
-	inboundConnections.clear();
+	inbound().clear();
 }
 
-void Node::maintenance()
+template<typename RolePolicy>
+void RoleNode<RolePolicy>::maintenance()
 {
+	maintenanceRequested = false;
+	if(!online) return;
+
+	unsigned int nOutboundBefore = nOutboundConnections;
+
+	// disconnects scheduled last tick, after their messages have been delivered
+	runDisconnect();
 	if(connections.empty()) {
 		//! \constraint We ask the dnsseeder multiple times, if we don't get peers from him.
 		DNSSeeder::ptr seed = simCTX->getDNSSeeder();
 		connect(seed->getCrawlerNode(), true);
 	}
-	runDisconnect();
 	fillConnections();
 	trickle();
+
+	scheduleNextMaintenance(nOutboundBefore);
+}
+
+void Node::requestMaintenance()
+{
+	// the crawler's maintenance is run by the simulation loop
+	if(maintenanceRequested || !online || role == CRAWLER) return;
+	maintenanceRequested = true;
+	simCTX->scheduleMaintenance(shared_from_this());
+}
+
+void Node::wakeUp()
+{
+	// only the latest back-off timer counts
+	if(nextWakeUp == Simulation::getSimClock()) {
+		requestMaintenance();
+	}
 }
 
-void Node::runDisconnect() 
+void Node::scheduleNextMaintenance(unsigned int nOutboundBefore)
 {
-	Node::vector discCopy = disconnectSchedule;
-	for (Node::ptr node : discCopy) {
+	// pending disconnects and addrs are handled next tick
+	if(!disconnectSchedule.empty() || hasPendingAddrs()) {
+		requestMaintenance();
+	}
+
+	unsigned int numberOfConnections = simCTX->getMaxOutbound() < knownNodes.size() ? simCTX->getMaxOutbound() : knownNodes.size();
+	if(!connections.empty() && nOutboundConnections >= numberOfConnections) {
+		maintenanceBackoff = 1;
+		return;
+	}
+
+	//! \constraint below the outbound target we retry right away while we make progress, else we back off exponentially
+	if(nOutboundConnections > nOutboundBefore) {
+		maintenanceBackoff = 1;
+	} else {
+		maintenanceBackoff = 2 * maintenanceBackoff < MAXMAINTENANCEBACKOFF ? 2 * maintenanceBackoff : MAXMAINTENANCEBACKOFF;
+	}
+	nextWakeUp = Simulation::getSimClock() + maintenanceBackoff;
+	simCTX->scheduleWakeUp(shared_from_this(), nextWakeUp);
+}
+
+bool Node::hasPendingAddrs()
+{
+	for(Node::vector* outbox : addrOutbox) {
+		if(outbox != nullptr) return true;
+	}
+	return false;
+}
+
+template<typename RolePolicy>
+void RoleNode<RolePolicy>::runDisconnect() 
+{
+	Node::scratch_vector discCopy(std::begin(disconnectSchedule), std::end(disconnectSchedule), *simCTX->getScratchArena());
+	for (const Node::ptr& node : discCopy) {
 		disconnect(node);
 	}
 	disconnectSchedule.clear();
@@ -330,22 +580,22 @@ void Node::runDisconnect()
 void Node::trickle()
 {
 	//! \constraint Bitcoins sends addr messages around every 100ms, but only with a probability of 1 / number of connections
-	Node::ptr trickleNode = randomNodeOfVector(connections);
-	if(trickleNode != nullptr) {
-		auto it = addrMessagesToSend.find(trickleNode->getID());
-		if(it != std::end(addrMessagesToSend)) {
-			sendAddrMsg(trickleNode, it->second);
-			addrMessagesToSend.erase(it);
-		}
+	if(connections.empty()) return;
+	unsigned int slot = rand() % connections.size();
+	Node::vector* outbox = addrOutbox[slot];
+	if(outbox != nullptr) {
+		addrOutbox[slot] = nullptr;
+		sendAddrMsg(connections[slot], outbox);
 	}
 }
 
-void Node::fillConnections(bool fOneShot)
+template<typename RolePolicy>
+void RoleNode<RolePolicy>::fillConnections(bool fOneShot)
 {
 
 	if(knownNodes.empty()) return;
-	// get Minimum of MAXOUTBOUNDPEERS and knownNodes.size() to determine to how many nodes we can connect
-	unsigned int numberOfConnections = MAXOUTBOUNDPEERS < knownNodes.size() ? MAXOUTBOUNDPEERS : knownNodes.size();
+	// get Minimum of the outbound limit and knownNodes.size() to determine to how many nodes we can connect
+	unsigned int numberOfConnections = simCTX->getMaxOutbound() < knownNodes.size() ? simCTX->getMaxOutbound() : knownNodes.size();
 
 	// Choose random Nodes of knownNodes
 	//! \constraint fill one connection per tick
@@ -361,18 +611,42 @@ void Node::fillConnections(bool fOneShot)
 
 bool Node::isReachable()
 {
-	return online && acceptInboundConnections;
+	return online && role != CLIENT;
 }
 
+bool Node::isOnline()
+{
+	return online;
+}
 
-Node::vector Node::getConnections()
+
+const Node::vector& Node::getConnections()
 {
 	return connections;
 }
 
-Node::vector Node::getInboundConnections()
+template<typename RolePolicy>
+const Node::vector& RoleNode<RolePolicy>::getInboundConnections()
+{
+	return inbound().get();
+}
+
+Node::Role Node::getRole() const
+{
+	return role;
+}
+
+bool InboundConnections<true>::contains(const Node::ptr& node)
+{
+	return nodeInVector(node, nodes);
+}
+
+bool InboundConnections<true>::remove(const Node::ptr& node)
 {
-	return inboundConnections;
+	auto it = findNodeInVector(node, nodes);
+	if(it == std::end(nodes)) return false;
+	nodes.erase(it);
+	return true;
 }
 
 std::string Node::generateRandomIP()
@@ -394,12 +668,12 @@ std::string Node::generateRandomIP()
 }
 
 
-CrawlerNode::CrawlerNode(Simulation* simCTX) : Node(simCTX, true, true)
+CrawlerNode::CrawlerNode(Simulation* simCTX) : RoleNode<CrawlerRole>(simCTX, true)
 {
 	// fill our goodNodes with all reachable nodes for bootstrap.
 	//! \constraint We assume that bootstrapping by iterating over all nodes is ok.
 	goodNodes.clear();
-	for (auto it : simCTX->getOnlineNodes()) {
+	for (const auto& it : simCTX->getOnlineNodes()) {
 		if(it->isReachable()) {
 			goodNodes.push_back(it);
 		}
@@ -407,15 +681,10 @@ CrawlerNode::CrawlerNode(Simulation* simCTX) : Node(simCTX, true, true)
 }
 CrawlerNode::~CrawlerNode() {}
 
-bool CrawlerNode::connect(Node::ptr destNode, bool fOneShot) 
-{
-	return Node::connect(destNode, true);
-}
-
 void CrawlerNode::maintenance()
 {
 	goodNodes.clear();
-	for (auto it : simCTX->getOnlineNodes()) {
+	for (const auto& it : simCTX->getOnlineNodes()) {
 		if(it->isReachable()) {
 			goodNodes.push_back(it);
 		}
@@ -425,11 +694,103 @@ void CrawlerNode::maintenance()
 	fillConnections(true);
 }
 
-Node::vector CrawlerNode::getGoodNodes() 
+const Node::vector& CrawlerNode::getGoodNodes()
 {
 	return goodNodes;
 }
 
+template class RoleNode<ClientRole>;
+template class RoleNode<ServerRole>;
+template class RoleNode<CrawlerRole>;
+
+//! calls the implementation of the node's role, without virtual dispatch
+#define ROLE_DISPATCH(call) \
+	switch(role) { \
+		case CLIENT: \
+			return static_cast<ClientNode*>(this)->call; \
+		case SERVER: \
+			return static_cast<ServerNode*>(this)->call; \
+		case CRAWLER: \
+			return static_cast<CrawlerNode*>(this)->call; \
+	}
+
+bool Node::inboundConnect(const Node::ptr& originNode)
+{
+	ROLE_DISPATCH(inboundConnect(originNode));
+	return false;
+}
+
+void Node::inboundDisconnect(const Node::ptr& originNode)
+{
+	ROLE_DISPATCH(inboundDisconnect(originNode));
+}
+
+void Node::connectionRejected(const Node::ptr& destNode)
+{
+	ROLE_DISPATCH(connectionRejected(destNode));
+}
+
+void Node::recvVersionMsg(const Node::ptr& senderNode)
+{
+	ROLE_DISPATCH(recvVersionMsg(senderNode));
+}
+
+void Node::stop()
+{
+	ROLE_DISPATCH(stop());
+}
+
+void Node::maintenance()
+{
+	ROLE_DISPATCH(maintenance());
+}
+
+void Node::fillConnections(bool fOneShot)
+{
+	ROLE_DISPATCH(fillConnections(fOneShot));
+}
+
+void Node::trimOutbound(unsigned int limit)
+{
+	// the crawler's one-shot connections close by themselves
+	const Node::vector& inbound = getInboundConnections();
+	Node::vector outbound;
+	for(const Node::ptr& peer : connections) {
+		if(peer->getIndex() != NOINDEX && !nodeInVector(peer, inbound)) {
+			outbound.push_back(peer);
+		}
+	}
+
+	// the newest connections are at the back
+	while(outbound.size() > limit) {
+		disconnect(outbound.back());
+		outbound.pop_back();
+	}
+}
+
+const Node::vector& Node::getInboundConnections()
+{
+	ROLE_DISPATCH(getInboundConnections());
+	static const Node::vector none;
+	return none;
+}
+
+bool Node::connect(const Node::ptr& destNode, bool fOneShot)
+{
+	ROLE_DISPATCH(connect(destNode, fOneShot));
+	return false;
+}
+
+void Node::disconnect(const Node::ptr& destNode)
+{
+	ROLE_DISPATCH(disconnect(destNode));
+}
+
+void Node::runDisconnect()
+{
+	ROLE_DISPATCH(runDisconnect());
+}
+
 DNSSeeder::DNSSeeder(Simulation* simCTX) : cacheHits(0), crawlerNode(std::make_shared<CrawlerNode>(simCTX)), simCTX(simCTX) 
 {
 	LOG("Starting DNSSeeder " << crawlerNode->getID());
@@ -437,7 +798,7 @@ DNSSeeder::DNSSeeder(Simulation* simCTX) : cacheHits(0), crawlerNode(std::make_s
 	cacheHit(true);
 }
 
-Node::vector DNSSeeder::queryDNS()
+const Node::vector& DNSSeeder::queryDNS()
 {
 	cacheHit();
 	return nodeCache;
@@ -450,7 +811,7 @@ CrawlerNode::ptr DNSSeeder::getCrawlerNode()
 
 void DNSSeeder::cacheHit(bool force)
 {
-	Node::vector goodNodes = crawlerNode->getGoodNodes();
+	const Node::vector& goodNodes = crawlerNode->getGoodNodes();
 	int cacheSize = nodeCache.size();
 	unsigned long now = Simulation::getSimClock();
 	cacheHits++;
@@ -473,9 +834,9 @@ void DNSSeeder::cacheHit(bool force)
 
 DNSSeeder::~DNSSeeder() {}
 
-Node::vector::iterator findNodeInVector(Node::ptr node, Node::vector& vector) 
+Node::vector::iterator findNodeInVector(const Node::ptr& node, Node::vector& vector) 
 {
-	auto it = std::find_if(vector.begin(), vector.end(), [node](Node::ptr const p) {
+	auto it = std::find_if(vector.begin(), vector.end(), [&node](const Node::ptr& p) {
 	    return (*p == *node);
 	});
 	return it;
@@ -483,18 +844,20 @@ Node::vector::iterator findNodeInVector(Node::ptr node, Node::vector& vector)
 
 Node::vector::iterator findNodeInVector(std::string nodeID, Node::vector& vector) 
 {
-	auto it = std::find_if(vector.begin(), vector.end(), [nodeID](Node::ptr const p) {
+	auto it = std::find_if(vector.begin(), vector.end(), [&nodeID](const Node::ptr& p) {
 	    return (p->getID() == nodeID);
 	});
 	return it;
 }
 
-bool nodeInVector(Node::ptr node, Node::vector& vector) 
+bool nodeInVector(const Node::ptr& node, const Node::vector& vector) 
 {
-	return findNodeInVector(node, vector) != std::end(vector);
+	return std::any_of(vector.begin(), vector.end(), [&node](const Node::ptr& p) {
+	    return (*p == *node);
+	});
 }
 
-Node::ptr randomNodeOfVector(Node::vector& v)
+Node::ptr randomNodeOfVector(const Node::vector& v)
 {
 	if(v.empty()) return nullptr;
 	unsigned int randomIndex = rand() % v.size();
@@ -512,15 +875,22 @@ Node::ptr randomNodeOfMap(Node::map& m)
 
 void nodeVectorToGraph(Node::vector& nodes, Graph& g)
 {
+	// map the population indices to the vertices
+	std::unordered_map<unsigned long, unsigned int> vertexOfNode;
+	for(unsigned int index = 0; index < nodes.size(); ++index) {
+		vertexOfNode[nodes.at(index)->getIndex()] = index;
+		g[index].server = nodes.at(index)->getRole() == Node::SERVER;
+	}
+
 	for(unsigned int index = 0; index < nodes.size(); ++index) {
 
 		// for connections
-		for(Node::ptr to : nodes.at(index)->getConnections()) {
+		for(const Node::ptr& to : nodes.at(index)->getConnections()) {
 
 			// find the node in allnodes
-			auto pos = findNodeInVector(to, nodes);
-			if(pos == std::end(nodes)) continue;
-			unsigned int toIndex = std::distance(std::begin(nodes), pos);
+			auto pos = vertexOfNode.find(to->getIndex());
+			if(pos == std::end(vertexOfNode)) continue;
+			unsigned int toIndex = pos->second;
 			if(toIndex == index) continue;
 
 			//add source vertex
@@ -536,3 +906,28 @@ void nodeVectorToGraph(Node::vector& nodes, Graph& g)
 		}
 	}
 }
+
+unsigned long countGraphEdges(const Node::vector& nodes)
+{
+	// mark the population indices of the nodes
+	unsigned long size = 0;
+	for(const Node::ptr& n : nodes) {
+		size = std::max(size, n->getIndex() + 1);
+	}
+	std::vector<bool> member(size);
+	for(const Node::ptr& n : nodes) {
+		member[n->getIndex()] = true;
+	}
+
+	// a connection is counted at its lower end, at the higher one only if the lower end doesn't list it
+	unsigned long edges = 0;
+	for(const Node::ptr& n : nodes) {
+		for(const Node::ptr& to : n->getConnections()) {
+			if(to->getIndex() >= size || !member[to->getIndex()] || to->getIndex() == n->getIndex()) continue;
+			if(n->getIndex() < to->getIndex() || !nodeInVector(n, to->getConnections())) {
+				++edges;
+			}
+		}
+	}
+	return edges;
+}
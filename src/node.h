@@ -10,13 +10,13 @@
 #include <memory>
 #include <unordered_map>
 #include <netinet/in.h>
+#include "arena.h"
+#include "bloom.h"
 #include <boost/graph/adjacency_list.hpp>
 #include <boost/graph/labeled_graph.hpp>
 #include <boost/graph/graphviz.hpp>
 #include <boost/graph/clustering_coefficient.hpp> // for clustering
 #include <boost/graph/exterior_property.hpp>
-#include <boost/graph/floyd_warshall_shortest.hpp>
-#include <boost/graph/geodesic_distance.hpp>
 
 class Simulation;
 class DNSSeeder;
@@ -30,53 +30,80 @@ class Node : public std::enable_shared_from_this<Node>
 public:
 	typedef std::shared_ptr<Node> ptr; //!< a shared_ptr of type Node.
 	typedef std::vector<std::shared_ptr<Node>> vector; //!< a vector of Nodes. 
+	typedef std::vector<std::shared_ptr<Node>, ScratchAllocator<std::shared_ptr<Node>>> scratch_vector; //!< a vector of Nodes in the scratch memory of the current tick.
 	typedef std::deque<std::shared_ptr<Node>> deque; //!< a deque of Nodes. 
 	typedef std::unordered_map<std::string, std::shared_ptr<Node>> map; //!< a map which maps strings to Nodes (meant to use the Node-IDs).
 
 	/*!
-	 * \brief initialize the Node
-	 * \param simCTX: a pointer to the simulation this Node belongs to.
-	 * \param acceptInboundConnections: decides if the Node will be a client or a server, defaults to server.
-	 * \param online decides if the Node will be online at creation. Only viable for CrawlerNodes (so far)
+	 * \brief the roles a Node can play, each one is implemented by a RoleNode
 	 */
-	Node(Simulation* simCTX, bool acceptInboundConnections = true, bool online = false);
+	enum Role {
+		CLIENT, //!< only makes outbound connections
+		SERVER, //!< also accepts inbound connections
+		CRAWLER //!< the crawler of the DNSSeeder, only makes fOneShot connections
+	};
+
 	~Node();
 
 	/*! 
 	 * \brief add a Node to our knownNodes list
 	 * \param node: the Node to add
 	 */
-	void addKnownNode(Node::ptr node);
+	void addKnownNode(const Node::ptr& node);
 
 	/*! 
 	 * \brief add  Node::vector to our knownNodes list
 	 * \param nodes: the Node::vector to add
 	 */
-	void addKnownNodes(Node::vector& nodes);
+	void addKnownNodes(const Node::vector& nodes);
+
+	/*!
+	 * \brief restores the knownNodes of a saved topology, they may be offline by now
+	 * \param nodes: the Node::vector to add
+	 */
+	void restoreKnownNodes(const Node::vector& nodes);
+
+	/*!
+	 * \brief returns the knownNodes, just for saving the topology
+	 * \return vector of known nodes
+	 */
+	Node::vector getKnownNodes();
 
 	/*! 
 	 * \brief remove a Node from our knownNodes list
 	 * \param node: the Node to remove
 	 */
-	void removeKnownNode(Node::ptr node);
+	void removeKnownNode(const Node::ptr& node);
 
 	/*!
 	 * @brief Is called by an other node's connect function to initiate a connection to this node
 	 * @param originNode is the Node the connection was made from.
 	 * @return true if connection was successful, else false.
 	 */
-	bool inboundConnect(Node::ptr originNode);
+	bool inboundConnect(const Node::ptr& originNode);
 
 	/*!
 	 * @brief Is called by an other node's disconnect function to end a connection to this node
 	 * @param originNode is the Node the connection was made from.
 	 */
-	void inboundDisconnect(Node::ptr originNode);
+	void inboundDisconnect(const Node::ptr& originNode);
+
+	/*!
+	 * @brief Is called when a Node of another shard rejected our connection request
+	 * @param destNode is the Node we tried to connect to.
+	 */
+	void connectionRejected(const Node::ptr& destNode);
+
+	/*!
+	 * @brief mirrors the online state of a Node which is simulated by another shard
+	 * @param online is the new online state
+	 */
+	void mirrorState(bool online);
 
 	/*!
 	 * \brief receives an "version" message
 	 */
-	void recvVersionMsg(Node::ptr senderNode);
+	void recvVersionMsg(const Node::ptr& senderNode);
 
 	/*!
 	 * \brief receives an "addr" message
@@ -84,13 +111,13 @@ public:
 	 * \param originNode the Node we got the addr message from.
 	 * \param vAddr is a Node::vector of addresses
 	 */
-	void recvAddrMsg(Node::ptr originNode, Node::vector& vAddr);
+	void recvAddrMsg(const Node::ptr& originNode, Node::vector& vAddr);
 
 
 	/*!
 	 * \brief receives an "getaddr" message
 	 */
-	void recvGetaddrMsg(Node::ptr senderNode);
+	void recvGetaddrMsg(const Node::ptr& senderNode);
 
 	/*!
 	 * \brief returns the ID of the Node, aka converts the Node IP to a String ID
@@ -98,6 +125,23 @@ public:
 	 */
 	std::string getID() const;
 
+	/*!
+	 * \brief returns the role of the Node
+	 */
+	Role getRole() const;
+
+	/*!
+	 * \brief returns the index of the Node in the simulated population
+	 * \return index of Node, NOINDEX if it isn't part of the population
+	 */
+	unsigned long getIndex() const;
+
+	/*!
+	 * \brief sets the index of the Node in the simulated population
+	 * \param index is the position of the Node in the population
+	 */
+	void setIndex(unsigned long index);
+
 	/*!
 	 * \brief bootstrap &  start this Node
 	 */
@@ -108,11 +152,33 @@ public:
 	 */
 	void stop();
 
+	/*!
+	 * \brief brings this Node online without bootstrapping, its connections are restored from a saved topology
+	 */
+	void warmStart();
+
+	/*!
+	 * \brief restores an outbound connection of a saved topology, without the handshake of connect()
+	 * \param destNode is the Node the connection was made to.
+	 * \return true if the connection could be restored, else false.
+	 */
+	bool restoreConnection(const Node::ptr& destNode);
+
 	/*!
 	 * \brief maintenance function which gets called regularly to clean up, refill connections etc.
 	 */
 	void maintenance();
 
+	/*!
+	 * \brief asks the simulation to run our maintenance next tick
+	 */
+	void requestMaintenance();
+
+	/*!
+	 * \brief called when a back-off timer of this node expires
+	 */
+	void wakeUp();
+
 	/*!
 	 * \brief try to connect until we have
 	 */
@@ -123,25 +189,43 @@ public:
 	 */
 	bool isReachable();
 
+	/*!
+	 * \brief returns if the node is online
+	 */
+	bool isOnline();
+
 	inline bool operator==(const Node& n){return (this->getID() == n.getID());} //!< checks if Nodes are the same by comparing their IDs.
 	inline bool operator!=(const Node& n){return !(*this == n);} //!< checks if Nodes are not the same by negating the result of the == op. 
 
 	/*!
 	 * \brief returns connections, just for the graph
-	 * \return vector of connected nodes
+	 * \return vector of connected nodes, only valid until the connections change
 	 */
-	Node::vector getConnections();
+	const Node::vector& getConnections();
 
 	/*!
 	 * \brief returns inbound connections, just for the graph
-	 * \return vector of connected nodes
+	 * \return vector of connected nodes, only valid until the connections change
 	 */
-	Node::vector getInboundConnections();
+	const Node::vector& getInboundConnections();
+
+	/*!
+	 * \brief closes the newest outbound connections above a limit, e.g. after the limit was lowered
+	 * \param limit is the number of outbound connections to keep
+	 */
+	void trimOutbound(unsigned int limit);
 protected:
+	/*!
+	 * \brief initialize the Node, only called by the RoleNode of its role
+	 * \param simCTX: a pointer to the simulation this Node belongs to.
+	 * \param role: the role of the Node.
+	 * \param online decides if the Node will be online at creation. Only viable for CrawlerNodes (so far)
+	 */
+	Node(Simulation* simCTX, Role role, bool online = false);
 
 	Node::map knownNodes; //!< The known Nodes of this Node
 	Simulation* simCTX; //!< the simulation the DNSSeeder belongs to
-	bool acceptInboundConnections; //!< does this node accept inbound connections?
+	const Role role; //!< the role of this node, selects the RoleNode implementation
 	bool online; //!< is this node online?
 
 	/*!
@@ -150,69 +234,225 @@ protected:
 	 * @param fOneShot determines if we disconnect after successful retrieval of addrs.
 	 * @return true if the connection could be established, else false.
 	 */
-	bool connect(Node::ptr destNode, bool fOneShot = false);
+	bool connect(const Node::ptr& destNode, bool fOneShot = false);
 
 	void checkConnections();
 	void runDisconnect();
 	void trickle();
-private:
-	void disconnect(Node::ptr destNode);
+
+	bool maintenanceRequested; //!< is this node already scheduled for the next tick?
+
+	void disconnect(const Node::ptr& destNode);
+
+	/*!
+	 * \brief decides when this node has to run its maintenance again
+	 * \param nOutboundBefore is the number of outbound connections before the maintenance ran
+	 */
+	void scheduleNextMaintenance(unsigned int nOutboundBefore);
+
+	/*!
+	 * \brief returns if there are addrs waiting in any outbox
+	 */
+	bool hasPendingAddrs();
 	
 	/*!
 	 * \brief sends an "version" message
 	 * \param receiverNode is the Node the message will be sent to
 	 */
-	void sendVersionMsg(Node::ptr receiverNode);
+	void sendVersionMsg(const Node::ptr& receiverNode);
 
 	/*! 
 	 * \brief sends an "getaddr" message to the node
 	 * \param receiverNode is the Node the message will be sent to
 	 */
-	void sendGetaddrMsg(Node::ptr receiverNode);
+	void sendGetaddrMsg(const Node::ptr& receiverNode);
 
 	/*! 
 	 * \brief sends an "addr" message to the node
 	 * \param receiverNode is the Node the message will be sent to.
-	 * \param vAddr is the Node::vector of addresses which will be sent to receiverNode.
+	 * \param vAddr is the pooled payload which will be sent to receiverNode, the message bus takes ownership of it.
 	 */
-	void sendAddrMsg(Node::ptr receiverNode, Node::vector& vAddr);
+	void sendAddrMsg(const Node::ptr& receiverNode, Node::vector* vAddr);
 
 	/*! 
 	 * \brief schedules "addr" messages to a node, which will be sent at next maintenance
 	 * \param receiverNode is the Node the message will be sent to.
 	 * \param vAddr is the Node::vector of addresses which will be sent to receiverNode.
 	 */
-	void scheduleAddrMsg(Node::ptr receiverNode, Node::vector& vAddr);
+	void scheduleAddrMsg(const Node::ptr& receiverNode, Node::vector& vAddr);
 
 	/*! 
-	 * \brief schedules a disconnect next tick, this is important for fOneShot
-	 * \param node is the node to disconnect from
+	 * \brief schedules a single address to a node, which will be sent at next maintenance
+	 * \param receiverNode is the Node the message will be sent to.
+	 * \param addr is the address which will be sent to receiverNode.
 	 */
-	void scheduleDisconnect(Node::ptr node);
+	void scheduleAddrMsg(const Node::ptr& receiverNode, const Node::ptr& addr);
 
 	/*!
-	 * \brief generates a random IP, also used as ID for the clients
-	 * \return std::string with the ID
+	 * \brief returns the connection slot of a node
+	 * \param node is the Node to look for
+	 * \return the index in connections, connections.size() if we aren't connected to node
 	 */
-	std::string generateRandomIP(); 
+	unsigned int connectionSlot(const Node::ptr& node);
 
+	/*!
+	 * \brief returns the addrs a connected node knows, creating the filter if needed
+	 * \param slot is the index of the connection in connections
+	 * \return the filter or nullptr, if the connection belongs to the crawler
+	 */
+	RollingBloomFilter* addrKnownOf(unsigned int slot);
+
+	/*!
+	 * \brief puts an address into the outbox of a connection, unless the peer already knows it
+	 * \param slot is the index of the connection in connections
+	 * \param addr is the address to send
+	 */
+	void pushAddr(unsigned int slot, const Node::ptr& addr);
+
+	/*!
+	 * \brief removes a connection slot together with its addr outbox
+	 * \param slot is the index of the connection in connections
+	 */
+	void eraseConnection(unsigned int slot);
+
+	/*! 
+	 * \brief schedules a disconnect next tick, this is important for fOneShot
+	 * \param node is the node to disconnect from
+	 */
+	void scheduleDisconnect(const Node::ptr& node);
 
-	std::string identifier; //!< the IP of the Node, also used as an ID
 	Node::vector connections; //!< The connected (outbound) Nodes
-	Node::vector inboundConnections; //!< open inbound connections
 	unsigned int nOutboundConnections;
-	unsigned int nInboundConnections;
 	Node::vector sendAddrNodes; //!< these nodes will be used to send addrs to for 24h, then there will be new ones.
 	Node::vector relayedAddrFrom; //!< saves the nodes we already relayed an addr message from
 	unsigned long sendAddrNodesLastFill; //!< Last time we filled the sendAddrNodes.
-	std::unordered_map<std::string, Node::vector> addrMessagesToSend; //! The vector of addr messages to send next tick.
+	std::vector<Node::vector*> addrOutbox; //!< pooled addr messages to send, indexed by connection slot (parallel to connections)
+	std::vector<RollingBloomFilter::ptr> addrKnown; //!< the addrs every connected node knows, indexed by connection slot, nullptr until first used and for the crawler
 	Node::vector disconnectSchedule; //!< Saves the node to disconnect from next tick
+	unsigned long maintenanceBackoff; //!< ticks to wait before retrying to fill connections
+	unsigned long nextWakeUp; //!< the time the current back-off timer expires
+
+private:
+	/*!
+	 * \brief generates a random IP, also used as ID for the clients
+	 * \return std::string with the ID
+	 */
+	std::string generateRandomIP(); 
+
+	std::string identifier; //!< the IP of the Node, also used as an ID
+	unsigned long index; //!< the position of the Node in the simulated population
 };
 
+/*!
+ * \brief the inbound connections of a role, roles which don't accept any carry no state
+ */
+template<bool acceptInboundConnections>
+class InboundConnections;
+
+/*!
+ * \brief the (empty) inbound connections of roles which don't accept any
+ */
+template<>
+class InboundConnections<false>
+{
+public:
+	bool contains(const Node::ptr&) const { return false; } //!< is the node connected inbound?
+	unsigned int size() const { return 0; } //!< number of inbound connections
+	void add(const Node::ptr&) {} //!< adds an inbound connection
+	bool remove(const Node::ptr&) { return false; } //!< removes an inbound connection, returns if it existed
+	void clear() {} //!< removes all inbound connections
+	const Node::vector& get() const { static const Node::vector none; return none; } //!< returns the inbound connections
+};
+
+/*!
+ * \brief the inbound connections of roles which accept them
+ */
+template<>
+class InboundConnections<true>
+{
+public:
+	bool contains(const Node::ptr& node); //!< is the node connected inbound?
+	unsigned int size() const { return nodes.size(); } //!< number of inbound connections
+	void add(const Node::ptr& node) { nodes.push_back(node); } //!< adds an inbound connection
+	bool remove(const Node::ptr& node); //!< removes an inbound connection, returns if it existed
+	void clear() { nodes.clear(); } //!< removes all inbound connections
+	const Node::vector& get() const { return nodes; } //!< returns the inbound connections
+private:
+	Node::vector nodes; //!< open inbound connections
+};
+
+/*!
+ * \brief the role policy of client nodes
+ */
+typedef struct ClientRole {
+	static constexpr Node::Role role = Node::CLIENT; //!< the role tag
+	static constexpr bool acceptInboundConnections = false; //!< does this role accept inbound connections?
+	static constexpr bool oneShotConnections = false; //!< does this role only make fOneShot connections?
+} ClientRole;
+
+/*!
+ * \brief the role policy of server nodes
+ */
+typedef struct ServerRole {
+	static constexpr Node::Role role = Node::SERVER; //!< the role tag
+	static constexpr bool acceptInboundConnections = true; //!< does this role accept inbound connections?
+	static constexpr bool oneShotConnections = false; //!< does this role only make fOneShot connections?
+} ServerRole;
+
+/*!
+ * \brief the role policy of the crawler of the DNSSeeder
+ */
+typedef struct CrawlerRole {
+	static constexpr Node::Role role = Node::CRAWLER; //!< the role tag
+	static constexpr bool acceptInboundConnections = true; //!< does this role accept inbound connections?
+	static constexpr bool oneShotConnections = true; //!< does this role only make fOneShot connections?
+} CrawlerRole;
+
+/*!
+ * \brief implements the role dependent parts of a Node for a role policy
+ *
+ * The Node dispatches its role dependent calls statically on its role tag. The policy decides at
+ * compile time which state the Node carries and how it connects, so e.g. clients carry no inbound
+ * state (the empty InboundConnections base takes no space) and their maintenance is compiled
+ * without any checks for inbound connections.
+ */
+template<typename RolePolicy>
+class RoleNode : public Node, private InboundConnections<RolePolicy::acceptInboundConnections>
+{
+public:
+	/*!
+	 * \brief initialize the Node
+	 * \param simCTX: a pointer to the simulation this Node belongs to.
+	 * \param online decides if the Node will be online at creation. Only viable for CrawlerNodes (so far)
+	 */
+	RoleNode(Simulation* simCTX, bool online = false);
+
+	bool inboundConnect(const Node::ptr& originNode); //!< \copydoc Node::inboundConnect
+	void inboundDisconnect(const Node::ptr& originNode); //!< \copydoc Node::inboundDisconnect
+	void connectionRejected(const Node::ptr& destNode); //!< \copydoc Node::connectionRejected
+	void recvVersionMsg(const Node::ptr& senderNode); //!< \copydoc Node::recvVersionMsg
+	void stop(); //!< \copydoc Node::stop
+	void maintenance(); //!< \copydoc Node::maintenance
+	void fillConnections(bool fOneShot = false); //!< \copydoc Node::fillConnections
+	const Node::vector& getInboundConnections(); //!< \copydoc Node::getInboundConnections
+	bool connect(const Node::ptr& destNode, bool fOneShot = false); //!< \copydoc Node::connect
+	void disconnect(const Node::ptr& destNode); //!< \copydoc Node::disconnect
+	void runDisconnect(); //!< \copydoc Node::runDisconnect
+
+protected:
+	/*!
+	 * \brief returns the inbound connections, an empty base for roles which don't accept them
+	 */
+	InboundConnections<RolePolicy::acceptInboundConnections>& inbound() { return *this; }
+};
+
+typedef RoleNode<ClientRole> ClientNode; //!< a client node, only making outbound connections
+typedef RoleNode<ServerRole> ServerNode; //!< a server node, also accepting inbound connections
+
 /*! 
  * \brief represents a crawler node for the DNSSeeder
  */
-class CrawlerNode : public Node {
+class CrawlerNode : public RoleNode<CrawlerRole> {
 
 public:
 	typedef std::shared_ptr<CrawlerNode> ptr; //!< a shared_ptr of type CrawlerNode.
@@ -225,15 +465,12 @@ public:
 	~CrawlerNode();
 
 	/*!
-	 * \brief Accessor to the goodNodes
+	 * \brief Accessor to the goodNodes, only valid until the next maintenance
 	 */
-	Node::vector getGoodNodes();
-
-	void maintenance();
+	const Node::vector& getGoodNodes();
 
-protected:
+	void maintenance(); //!< \copydoc Node::maintenance
 
-	bool connect(Node::ptr destNode, bool fOneShot = true);
 private:
 	Node::vector goodNodes; //!< only the good Nodes \todo implement goodNodes!
 };
@@ -256,9 +493,9 @@ public:
 
 	/*!
 	 * \brief represents a query to the DNSSeeder
-	 * \return list of Nodes for bootstrapping
+	 * \return list of Nodes for bootstrapping, only valid until the next query
 	 */
-	Node::vector queryDNS();
+	const Node::vector& queryDNS();
 
 	/*!
 	 * \brief Returns the crawler node
@@ -279,14 +516,14 @@ private:
  * \param node to search
  * \param vector to look in
  */
-bool nodeInVector(Node::ptr node, Node::vector& vector);
+bool nodeInVector(const Node::ptr& node, const Node::vector& vector);
 
 /*!
  * \brief Finds a node in the given vector
  * \param node to find
  * \param vector to look in
  */
-Node::vector::iterator findNodeInVector(Node::ptr node, Node::vector& vector);
+Node::vector::iterator findNodeInVector(const Node::ptr& node, Node::vector& vector);
 Node::vector::iterator findNodeInVector(std::string nodeID, Node::vector& vector);
 
 /*!
@@ -294,7 +531,7 @@ Node::vector::iterator findNodeInVector(std::string nodeID, Node::vector& vector
  * \param vector to look in
  * \return random node
  */
-Node::ptr randomNodeOfVector(Node::vector& v);
+Node::ptr randomNodeOfVector(const Node::vector& v);
 
 /*!
  * \brief returns a random Node out of a map
@@ -309,6 +546,7 @@ Node::ptr randomNodeOfMap(Node::map& m);
  * \brief Properties which represent an vertex of the graph.
  */
 typedef struct VertexProperty {
+	bool server = false; //!< does the node accept inbound connections?
  } VertexProperty;
 
 /*!
@@ -327,14 +565,6 @@ typedef boost::exterior_vertex_property<Graph, float> ClusteringProperty;
 typedef ClusteringProperty::container_type ClusteringContainer;
 typedef ClusteringProperty::map_type ClusteringMap;
 
-// for geodesic mean path
-typedef boost::exterior_vertex_property<Graph, float> DistanceProperty;
-typedef DistanceProperty::matrix_type DistanceMatrix;
-typedef DistanceProperty::matrix_map_type DistanceMatrixMap;
-typedef boost::exterior_vertex_property<Graph, float> GeodesicProperty;
-typedef GeodesicProperty::container_type GeodesicContainer;
-typedef GeodesicProperty::map_type GeodesicMap;
-typedef boost::property_map<Graph, float EdgeProperty::*>::type WeightMap;
 /*!
  * \brief generates a boost Graph from a node vector
  * \param node vector to use
@@ -342,4 +572,11 @@ typedef boost::property_map<Graph, float EdgeProperty::*>::type WeightMap;
  */
 void nodeVectorToGraph(Node::vector& nodes, Graph& g);
 
+/*!
+ * \brief counts the edges nodeVectorToGraph generates from a node vector, without building the graph
+ * \param nodes is the node vector
+ * \return the number of distinct connections between the nodes
+ */
+unsigned long countGraphEdges(const Node::vector& nodes);
+
 #endif // NODE_H
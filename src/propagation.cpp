@@ -0,0 +1,142 @@
+#include "propagation.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <random>
+#include <thread>
+#include <utility>
+
+PropagationEngine::PropagationEngine(const CSRGraph& g, uint32_t minLatency, uint32_t maxLatency) : g(g), minLatency(minLatency), maxLatency(maxLatency)
+{
+	//! \constraint a message needs at least 1ms per hop, so an arrival never lands in the slot being processed
+	if(this->minLatency < 1) this->minLatency = 1;
+	if(this->maxLatency < this->minLatency) this->maxLatency = this->minLatency;
+}
+
+uint32_t PropagationEngine::latency(uint32_t u, uint32_t v) const
+{
+	if(minLatency == maxLatency) return minLatency;
+
+	// both directions of an edge hash to the same latency
+	uint64_t h = ((uint64_t) std::min(u, v) << 32) | std::max(u, v);
+	h += 0x9e3779b97f4a7c15ULL;
+	h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+	h ^= h >> 31;
+	return minLatency + h % (maxLatency - minLatency + 1);
+}
+
+std::vector<uint32_t> PropagationEngine::pickSources(unsigned long count, unsigned long seed)
+{
+	uint32_t n = g.numVertices();
+	std::vector<uint32_t> vertices(n);
+	for(uint32_t v = 0; v < n; ++v) {
+		vertices[v] = v;
+	}
+	if(count >= n) return vertices;
+
+	// partial Fisher-Yates shuffle
+	std::mt19937 rng(seed);
+	for(unsigned long i = 0; i < count; ++i) {
+		std::uniform_int_distribution<uint32_t> pick(i, n - 1);
+		std::swap(vertices[i], vertices[pick(rng)]);
+	}
+	vertices.resize(count);
+	return vertices;
+}
+
+PropagationStats PropagationEngine::simulate(const std::vector<uint32_t>& sources, unsigned int threads)
+{
+	unsigned long blocks = (sources.size() + 63) / 64;
+	std::vector<uint32_t> times(sources.size() * PROPAGATIONCOVERAGES, UINT32_MAX);
+	std::atomic<unsigned long> nextBlock(0);
+
+	auto worker = [&]() {
+		for(unsigned long block = nextBlock++; block < blocks; block = nextBlock++) {
+			unsigned long first = block * 64;
+			unsigned int count = std::min<unsigned long>(64, sources.size() - first);
+			simulateBlock(sources.data() + first, count, times.data() + first * PROPAGATIONCOVERAGES);
+		}
+	};
+
+	std::vector<std::thread> workers;
+	for(unsigned int i = 1; i < threads && i < blocks; ++i) {
+		workers.emplace_back(worker);
+	}
+	worker();
+	for(std::thread& t : workers) {
+		t.join();
+	}
+
+	PropagationStats stats;
+	stats.sources = sources.size();
+	for(unsigned int c = 0; c < PROPAGATIONCOVERAGES; ++c) {
+		double sum = 0;
+		unsigned long reached = 0;
+		for(unsigned long s = 0; s < sources.size(); ++s) {
+			uint32_t time = times[s * PROPAGATIONCOVERAGES + c];
+			if(time == UINT32_MAX) {
+				stats.unreached[c]++;
+				continue;
+			}
+			sum += time;
+			reached++;
+			stats.maxTime[c] = std::max(stats.maxTime[c], time);
+		}
+		stats.meanTime[c] = reached > 0 ? sum / reached : 0;
+	}
+	return stats;
+}
+
+void PropagationEngine::simulateBlock(const uint32_t* sources, unsigned int count, uint32_t* times)
+{
+	uint32_t n = g.numVertices();
+	uint32_t slots = maxLatency + 1;
+
+	// the number of vertices every coverage needs
+	uint32_t target[PROPAGATIONCOVERAGES];
+	for(unsigned int c = 0; c < PROPAGATIONCOVERAGES; ++c) {
+		target[c] = std::max<uint32_t>(1, std::ceil(PROPAGATIONCOVERAGE[c] * n));
+	}
+
+	// per vertex the origins which already reached it, per origin the number of vertices it reached
+	std::vector<uint64_t> reached(n, 0);
+	std::vector<uint32_t> covered(count, 0);
+
+	// per slot the arrivals as (vertex, origins)
+	std::vector<std::vector<std::pair<uint32_t, uint64_t>>> calendar(slots);
+	unsigned long pending = 0;
+
+	for(unsigned int i = 0; i < count; ++i) {
+		calendar[0].push_back(std::make_pair(sources[i], 1ULL << i));
+		pending++;
+	}
+
+	for(uint32_t now = 0; pending > 0; ++now) {
+		std::vector<std::pair<uint32_t, uint64_t>>& arrivals = calendar[now % slots];
+		for(std::pair<uint32_t, uint64_t>& arrival : arrivals) {
+			uint32_t v = arrival.first;
+			uint64_t fresh = arrival.second & ~reached[v];
+			if(fresh == 0) continue;
+			reached[v] |= fresh;
+
+			for(uint64_t bits = fresh; bits != 0; bits &= bits - 1) {
+				unsigned int origin = __builtin_ctzll(bits);
+				uint32_t c = ++covered[origin];
+				for(unsigned int k = 0; k < PROPAGATIONCOVERAGES; ++k) {
+					if(c == target[k]) times[origin * PROPAGATIONCOVERAGES + k] = now;
+				}
+			}
+
+			// relay to the neighbors which haven't seen these messages yet
+			for(const uint32_t* it = g.neighborsBegin(v); it != g.neighborsEnd(v); ++it) {
+				uint64_t relay = fresh & ~reached[*it];
+				if(relay == 0) continue;
+				calendar[(now + latency(v, *it)) % slots].push_back(std::make_pair(*it, relay));
+				pending++;
+			}
+		}
+		pending -= arrivals.size();
+		arrivals.clear();
+	}
+}
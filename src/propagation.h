@@ -0,0 +1,77 @@
+/*!
+ * \brief The propagation of messages (e.g. blocks) over a graph
+ */
+
+#ifndef PROPAGATION_H
+#define PROPAGATION_H
+
+#include "csrgraph.h"
+#include <cstdint>
+#include <vector>
+
+/*!
+ * \brief The coverage fractions propagation times are reported for
+ */
+static const double PROPAGATIONCOVERAGE[] = {0.5, 0.9, 0.99};
+static const unsigned int PROPAGATIONCOVERAGES = sizeof(PROPAGATIONCOVERAGE) / sizeof(PROPAGATIONCOVERAGE[0]);
+
+/*!
+ * \brief The propagation times of the flooded messages.
+ */
+typedef struct PropagationStats {
+	unsigned long sources = 0; //!< number of origin vertices which flooded a message
+	double meanTime[PROPAGATIONCOVERAGES] = {}; //!< per coverage: mean time until reached, over the sources which reached it (ms)
+	uint32_t maxTime[PROPAGATIONCOVERAGES] = {}; //!< per coverage: the slowest source which reached it (ms)
+	unsigned long unreached[PROPAGATIONCOVERAGES] = {}; //!< per coverage: number of sources which never reached it
+} PropagationStats;
+
+/*!
+ * \brief Floods messages from many origin vertices at once over a CSRGraph.
+ *
+ * 64 origins share one pass: every vertex keeps a word of the origins which already
+ * reached it and every pending arrival is a word of origins, so a relay step forwards
+ * all of them with a single OR. Every edge has a fixed latency in whole milliseconds,
+ * the arrivals are bucketed in a calendar queue of maxLatency + 1 slots.
+ */
+class PropagationEngine
+{
+public:
+	/*!
+	 * \param g is the graph to flood.
+	 * \param minLatency is the smallest latency of an edge in ms.
+	 * \param maxLatency is the largest latency of an edge in ms, every edge draws a fixed latency in between.
+	 */
+	PropagationEngine(const CSRGraph& g, uint32_t minLatency, uint32_t maxLatency);
+
+	/*!
+	 * \brief floods one message from each of the given origins
+	 * \param sources are the origin vertices.
+	 * \param threads is the number of threads, the origins are processed in blocks of 64 per thread.
+	 * \return the propagation times
+	 */
+	PropagationStats simulate(const std::vector<uint32_t>& sources, unsigned int threads);
+
+	/*!
+	 * \brief picks distinct origin vertices at random
+	 * \param count is the number of origins, all vertices are picked if the graph is smaller.
+	 * \param seed seeds the random number generator, so both graphs can use the same draw.
+	 */
+	std::vector<uint32_t> pickSources(unsigned long count, unsigned long seed);
+
+private:
+	uint32_t latency(uint32_t u, uint32_t v) const; //!< the fixed latency of an edge
+
+	/*!
+	 * \brief floods a block of up to 64 origins
+	 * \param sources are the origins of the block.
+	 * \param count is the number of origins in the block.
+	 * \param times will hold the time every origin reached each coverage (origin * PROPAGATIONCOVERAGES + coverage), UINT32_MAX if never.
+	 */
+	void simulateBlock(const uint32_t* sources, unsigned int count, uint32_t* times);
+
+	const CSRGraph& g; //!< the graph to flood
+	uint32_t minLatency; //!< the smallest latency of an edge in ms
+	uint32_t maxLatency; //!< the largest latency of an edge in ms
+};
+
+#endif // PROPAGATION_H
@@ -0,0 +1,135 @@
+#include "resilience.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <random>
+#include <thread>
+
+static const uint32_t ABSENT = UINT32_MAX; //!< the parent of a vertex which isn't added back yet
+
+static uint32_t findRoot(std::vector<uint32_t>& parent, uint32_t v)
+{
+	// path halving
+	while(parent[v] != v) {
+		parent[v] = parent[parent[v]];
+		v = parent[v];
+	}
+	return v;
+}
+
+ResilienceEngine::ResilienceEngine(const CSRGraph& g, unsigned int threads) : g(g), threads(threads)
+{
+	if(this->threads == 0) {
+		this->threads = std::max(1u, std::thread::hardware_concurrency());
+	}
+}
+
+void ResilienceEngine::sweep(const std::vector<uint32_t>& order, std::vector<uint32_t>& giant, std::vector<uint32_t>& parent, std::vector<uint32_t>& size)
+{
+	uint32_t n = order.size();
+	parent.assign(n, ABSENT);
+	size.assign(n, 1);
+	giant.assign(n + 1, 0);
+
+	// after all n removals nothing is left, the last removed vertex is added back first
+	uint32_t largest = 0;
+	for(uint32_t k = n; k > 0; --k) {
+		uint32_t v = order[k - 1];
+		parent[v] = v;
+		largest = std::max(largest, 1u);
+		for(const uint32_t* u = g.neighborsBegin(v); u != g.neighborsEnd(v); ++u) {
+			if(parent[*u] == ABSENT) continue;
+			uint32_t a = findRoot(parent, v), b = findRoot(parent, *u);
+			if(a == b) continue;
+
+			// union by size
+			if(size[a] < size[b]) std::swap(a, b);
+			parent[b] = a;
+			size[a] += size[b];
+			largest = std::max(largest, size[a]);
+		}
+		giant[k - 1] = largest;
+	}
+}
+
+ResilienceCurve ResilienceEngine::summarize(const std::vector<double>& giant)
+{
+	ResilienceCurve curve;
+	uint32_t n = giant.size() - 1;
+	if(n == 0) return curve;
+
+	for(unsigned int f = 0; f < REMOVALFRACTIONS; ++f) {
+		uint32_t removed = std::min<uint32_t>(n, std::round(REMOVALFRACTION[f] * n));
+		curve.giant[f] = giant[removed] / n;
+	}
+	double sum = 0;
+	for(uint32_t k = 1; k <= n; ++k) {
+		sum += giant[k];
+	}
+	curve.robustness = sum / n / n;
+	return curve;
+}
+
+ResilienceCurve ResilienceEngine::removeInOrder(const std::vector<uint32_t>& order)
+{
+	std::vector<uint32_t> giant, parent, size;
+	sweep(order, giant, parent, size);
+	return summarize(std::vector<double>(std::begin(giant), std::end(giant)));
+}
+
+ResilienceCurve ResilienceEngine::removeRandomly(unsigned long runs, unsigned long seed, const std::vector<bool>& first)
+{
+	uint32_t n = g.numVertices();
+	std::vector<std::vector<double>> partial(threads, std::vector<double>(n + 1, 0));
+	std::atomic<unsigned long> nextRun(0);
+
+	auto worker = [&](unsigned int id) {
+		// per thread state, reused by every sweep
+		std::vector<uint32_t> order(n), giant, parent, size;
+		std::vector<double>& sum = partial[id];
+		for(unsigned long run = nextRun++; run < runs; run = nextRun++) {
+			// the order of a run only depends on its seed, not on the thread
+			std::mt19937 rng(seed + run);
+			for(uint32_t v = 0; v < n; ++v) {
+				order[v] = v;
+			}
+			std::shuffle(std::begin(order), std::end(order), rng);
+			if(!first.empty()) {
+				std::stable_partition(std::begin(order), std::end(order), [&first](uint32_t v) { return first[v]; });
+			}
+			sweep(order, giant, parent, size);
+			for(uint32_t k = 0; k <= n; ++k) {
+				sum[k] += giant[k];
+			}
+		}
+	};
+
+	std::vector<std::thread> workers;
+	for(unsigned int id = 1; id < threads && id < runs; ++id) {
+		workers.emplace_back(worker, id);
+	}
+	worker(0);
+	for(std::thread& t : workers) {
+		t.join();
+	}
+
+	std::vector<double> mean(n + 1, 0);
+	for(std::vector<double>& sum : partial) {
+		for(uint32_t k = 0; k <= n; ++k) {
+			mean[k] += sum[k] / std::max(1ul, runs);
+		}
+	}
+	return summarize(mean);
+}
+
+std::vector<uint32_t> ResilienceEngine::degreeOrder()
+{
+	std::vector<uint32_t> order(g.numVertices());
+	for(uint32_t v = 0; v < order.size(); ++v) {
+		order[v] = v;
+	}
+	std::stable_sort(std::begin(order), std::end(order), [this](uint32_t a, uint32_t b) {
+		return g.degree(a) > g.degree(b);
+	});
+	return order;
+}
@@ -0,0 +1,77 @@
+/*!
+ * \brief How a graph breaks apart when its vertices fail or are attacked
+ */
+
+#ifndef RESILIENCE_H
+#define RESILIENCE_H
+
+#include "csrgraph.h"
+#include <cstdint>
+#include <vector>
+
+/*!
+ * \brief The removed fractions of the vertices the size of the giant component is reported for
+ */
+static const double REMOVALFRACTION[] = {0.01, 0.05, 0.1, 0.2, 0.3, 0.5, 0.7, 0.9};
+static const unsigned int REMOVALFRACTIONS = sizeof(REMOVALFRACTION) / sizeof(REMOVALFRACTION[0]);
+
+/*!
+ * \brief The size of the giant component while the vertices are removed in some order.
+ */
+typedef struct ResilienceCurve {
+	double giant[REMOVALFRACTIONS] = {}; //!< per removed fraction: the vertices in the largest component, relative to all vertices
+	double robustness = 0; //!< the mean of the relative giant component over all removal steps, 0.5 is the most robust
+} ResilienceCurve;
+
+/*!
+ * \brief Removes the vertices of a CSRGraph one by one and tracks the largest component.
+ *
+ * Instead of a component search per removal step, the vertices are added back in the reverse
+ * order and joined with their present neighbors in a union-find (Newman and Ziff), so a whole
+ * curve takes near-linear time.
+ */
+class ResilienceEngine
+{
+public:
+	/*!
+	 * \param g is the graph to break apart.
+	 * \param threads is the number of threads for the random orders, 0 uses one per hardware thread.
+	 */
+	ResilienceEngine(const CSRGraph& g, unsigned int threads);
+
+	/*!
+	 * \brief removes the vertices in the given order
+	 * \param order are all vertices, the first one is removed first.
+	 */
+	ResilienceCurve removeInOrder(const std::vector<uint32_t>& order);
+
+	/*!
+	 * \brief removes the vertices in random orders and averages the curves
+	 * \param runs is the number of random orders.
+	 * \param seed seeds the random number generator of the first order, the others use the following seeds.
+	 * \param first flags the vertices which are removed before all others (e.g. the servers), empty for none.
+	 */
+	ResilienceCurve removeRandomly(unsigned long runs, unsigned long seed, const std::vector<bool>& first = std::vector<bool>());
+
+	/*!
+	 * \brief returns the vertices by decreasing degree, the attack on the hubs
+	 */
+	std::vector<uint32_t> degreeOrder();
+
+private:
+	/*!
+	 * \brief adds the vertices back in the reverse order
+	 * \param order is the removal order.
+	 * \param giant will hold the size of the largest component after k removals at index k.
+	 * \param parent is the union-find forest, reused between the sweeps.
+	 * \param size is the size of every root's component, reused between the sweeps.
+	 */
+	void sweep(const std::vector<uint32_t>& order, std::vector<uint32_t>& giant, std::vector<uint32_t>& parent, std::vector<uint32_t>& size);
+
+	ResilienceCurve summarize(const std::vector<double>& giant); //!< picks the reported points of a curve of absolute sizes
+
+	const CSRGraph& g; //!< the graph to break apart
+	unsigned int threads; //!< the number of threads
+};
+
+#endif // RESILIENCE_H
@@ -0,0 +1,339 @@
+#include "shard.h"
+#include "bittopsim.h"
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+void ShardRing::init()
+{
+	head = 0;
+	tail = 0;
+}
+
+unsigned long ShardRing::write(const uint32_t* data, unsigned long count)
+{
+	unsigned long t = tail.load(std::memory_order_relaxed);
+	unsigned long free = SHARDRINGSIZE - (t - head.load(std::memory_order_acquire));
+	unsigned long n = count < free ? count : free;
+	for(unsigned long i = 0; i < n; ++i) {
+		words[(t + i) % SHARDRINGSIZE] = data[i];
+	}
+	tail.store(t + n, std::memory_order_release);
+	return n;
+}
+
+void ShardRing::read(std::vector<uint32_t>& out)
+{
+	unsigned long h = head.load(std::memory_order_relaxed);
+	unsigned long t = tail.load(std::memory_order_acquire);
+	for(; h < t; ++h) {
+		out.push_back(words[h % SHARDRINGSIZE]);
+	}
+	head.store(h, std::memory_order_release);
+}
+
+ShardContext::ShardContext(unsigned int numberOfShards, unsigned long window) : numberOfShards(numberOfShards), shardIndex(0), window(window), outgoing(numberOfShards), incoming(numberOfShards)
+{
+	// layout: barrier | pending flags | rings between the shards | rings to the parent
+	unsigned long pendingOffset = (sizeof(pthread_barrier_t) + 63) / 64 * 64;
+	unsigned long ringsOffset = (pendingOffset + numberOfShards * sizeof(std::atomic<unsigned long>) + 63) / 64 * 64;
+	unsigned long numberOfRings = numberOfShards * numberOfShards + numberOfShards;
+	memorySize = ringsOffset + numberOfRings * sizeof(ShardRing);
+
+	//! \constraint the rings are mapped lazily, only the pages which are actually used take memory
+	memory = mmap(nullptr, memorySize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	if(memory == MAP_FAILED) {
+		perror("mmap");
+		exit(EXIT_FAILURE);
+	}
+
+	barrier = static_cast<pthread_barrier_t*>(memory);
+	pthread_barrierattr_t attr;
+	pthread_barrierattr_init(&attr);
+	pthread_barrierattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+	pthread_barrier_init(barrier, &attr, numberOfShards);
+	pthread_barrierattr_destroy(&attr);
+
+	pending = reinterpret_cast<std::atomic<unsigned long>*>(static_cast<char*>(memory) + pendingOffset);
+	rings = reinterpret_cast<ShardRing*>(static_cast<char*>(memory) + ringsOffset);
+	for(unsigned int i = 0; i < numberOfShards; ++i) {
+		pending[i] = 0;
+	}
+	for(unsigned long i = 0; i < numberOfRings; ++i) {
+		rings[i].init();
+	}
+}
+
+ShardContext::~ShardContext()
+{
+	pthread_barrier_destroy(barrier);
+	munmap(memory, memorySize);
+}
+
+void ShardContext::attach(unsigned int shardIndex)
+{
+	this->shardIndex = shardIndex;
+}
+
+unsigned long ShardContext::getWindow()
+{
+	return window;
+}
+
+ShardRing* ShardContext::ring(unsigned int from, unsigned int to)
+{
+	return &rings[from * numberOfShards + to];
+}
+
+ShardRing* ShardContext::parentRing(unsigned int from)
+{
+	return &rings[numberOfShards * numberOfShards + from];
+}
+
+unsigned int ShardContext::shardOf(const Node::ptr& node)
+{
+	return node->getIndex() % numberOfShards;
+}
+
+bool ShardContext::isLocal(const Node::ptr& node)
+{
+	//! \constraint Nodes outside of the population (the CrawlerNode of every worker) are always local
+	return node->getIndex() == NOINDEX || shardOf(node) == shardIndex;
+}
+
+bool ShardContext::connect(const Node::ptr& originNode, const Node::ptr& destNode)
+{
+	// the crawler of a worker only crawls the local nodes
+	if(originNode->getIndex() == NOINDEX) return false;
+
+	std::vector<uint32_t>& batch = outgoing[shardOf(destNode)];
+	batch.push_back(CONNECT);
+	batch.push_back(originNode->getIndex());
+	batch.push_back(destNode->getIndex());
+	return true;
+}
+
+void ShardContext::disconnect(const Node::ptr& originNode, const Node::ptr& destNode)
+{
+	if(originNode->getIndex() == NOINDEX) return;
+
+	std::vector<uint32_t>& batch = outgoing[shardOf(destNode)];
+	batch.push_back(DISCONNECT);
+	batch.push_back(originNode->getIndex());
+	batch.push_back(destNode->getIndex());
+}
+
+void ShardContext::post(Message::Type type, const Node::ptr& sender, const Node::ptr& receiver, Node::vector* addr)
+{
+	if(sender->getIndex() == NOINDEX) return;
+
+	std::vector<uint32_t>& batch = outgoing[shardOf(receiver)];
+	switch(type) {
+		case Message::VERSION:
+			batch.push_back(VERSION);
+			break;
+		case Message::GETADDR:
+			batch.push_back(GETADDR);
+			break;
+		case Message::ADDR:
+			batch.push_back(ADDR);
+			break;
+	}
+	batch.push_back(sender->getIndex());
+	batch.push_back(receiver->getIndex());
+
+	if(type == Message::ADDR) {
+		unsigned long sizePos = batch.size();
+		batch.push_back(0);
+		for(const Node::ptr& n : *addr) {
+			if(n->getIndex() != NOINDEX) {
+				batch.push_back(n->getIndex());
+			}
+		}
+		batch[sizePos] = batch.size() - sizePos - 1;
+	}
+}
+
+void ShardContext::broadcastState(const Node::ptr& node, bool online)
+{
+	for(unsigned int i = 0; i < numberOfShards; ++i) {
+		if(i == shardIndex) continue;
+		outgoing[i].push_back(online ? ONLINE : OFFLINE);
+		outgoing[i].push_back(node->getIndex());
+	}
+}
+
+void ShardContext::exchange(Simulation* simCTX)
+{
+	std::vector<unsigned long> sent(numberOfShards, 0);
+	bool more = true;
+
+	//! \constraint batches larger than a ring are exchanged in several rounds
+	while(more) {
+		bool left = false;
+		for(unsigned int i = 0; i < numberOfShards; ++i) {
+			if(i == shardIndex) continue;
+			std::vector<uint32_t>& batch = outgoing[i];
+			sent[i] += ring(shardIndex, i)->write(batch.data() + sent[i], batch.size() - sent[i]);
+			left = left || sent[i] < batch.size();
+		}
+		pthread_barrier_wait(barrier);
+
+		for(unsigned int i = 0; i < numberOfShards; ++i) {
+			if(i == shardIndex) continue;
+			ring(i, shardIndex)->read(incoming[i]);
+		}
+		pending[shardIndex] = left ? 1 : 0;
+		pthread_barrier_wait(barrier);
+
+		more = false;
+		for(unsigned int i = 0; i < numberOfShards; ++i) {
+			more = more || pending[i] != 0;
+		}
+	}
+
+	for(unsigned int i = 0; i < numberOfShards; ++i) {
+		outgoing[i].clear();
+		apply(simCTX, incoming[i]);
+		incoming[i].clear();
+	}
+}
+
+void ShardContext::apply(Simulation* simCTX, std::vector<uint32_t>& records)
+{
+	MessageBus::ptr bus = simCTX->getMessageBus();
+	unsigned long pos = 0;
+	while(pos < records.size()) {
+		uint32_t type = records[pos++];
+		Node::ptr from = simCTX->getNode(records[pos++]);
+
+		switch(type) {
+			case ONLINE:
+				from->mirrorState(true);
+				continue;
+			case OFFLINE:
+				from->mirrorState(false);
+				continue;
+		}
+
+		Node::ptr to = simCTX->getNode(records[pos++]);
+		switch(type) {
+			case CONNECT:
+				//! \constraint the mirrored state the origin saw may be one window old, so we check again
+				if(!to->isReachable() || !to->inboundConnect(from)) {
+					std::vector<uint32_t>& batch = outgoing[shardOf(from)];
+					batch.push_back(REJECT);
+					batch.push_back(to->getIndex());
+					batch.push_back(from->getIndex());
+				}
+				break;
+			case REJECT:
+				to->connectionRejected(from);
+				break;
+			case DISCONNECT:
+				to->inboundDisconnect(from);
+				break;
+			case VERSION:
+				bus->post(Message::VERSION, from, to);
+				break;
+			case GETADDR:
+				bus->post(Message::GETADDR, from, to);
+				break;
+			case ADDR: {
+				Node::vector* addr = bus->acquireAddrBuffer();
+				uint32_t size = records[pos++];
+				for(uint32_t i = 0; i < size; ++i) {
+					addr->push_back(simCTX->getNode(records[pos++]));
+				}
+				bus->post(Message::ADDR, from, to, addr);
+				break;
+			}
+		}
+	}
+}
+
+void ShardContext::sendTopology(Node::vector& nodes)
+{
+	// record per online node: index, number of connections, connected indices
+	std::vector<uint32_t> topology;
+	topology.push_back(0);
+	for(const Node::ptr& n : nodes) {
+		if(!isLocal(n)) continue;
+		const Node::vector& connections = n->getConnections();
+		topology.push_back(n->getIndex());
+		unsigned long sizePos = topology.size();
+		topology.push_back(0);
+		for(const Node::ptr& c : connections) {
+			if(c->getIndex() != NOINDEX) {
+				topology.push_back(c->getIndex());
+			}
+		}
+		topology[sizePos] = topology.size() - sizePos - 1;
+	}
+	topology[0] = topology.size() - 1;
+
+	unsigned long sent = 0;
+	while(sent < topology.size()) {
+		unsigned long n = parentRing(shardIndex)->write(topology.data() + sent, topology.size() - sent);
+		if(n == 0) sched_yield();
+		sent += n;
+	}
+}
+
+bool ShardContext::collectTopology(std::vector<pid_t>& workers, unsigned long numberOfNodes, std::vector<std::vector<uint32_t>>& adjacency, std::vector<bool>& online)
+{
+	std::vector<std::vector<uint32_t>> streams(numberOfShards);
+	std::vector<bool> exited(numberOfShards, false);
+	unsigned int complete = 0;
+
+	// the parent drains the rings while the workers are still writing
+	while(complete < numberOfShards) {
+		for(unsigned int i = 0; i < numberOfShards; ++i) {
+			std::vector<uint32_t>& stream = streams[i];
+			bool done = !stream.empty() && stream.size() == stream[0] + 1;
+			if(done) continue;
+
+			parentRing(i)->read(stream);
+			if(!stream.empty() && stream.size() == stream[0] + 1) {
+				complete++;
+				continue;
+			}
+
+			int status;
+			if(!exited[i] && waitpid(workers[i], &status, WNOHANG) == workers[i]) {
+				exited[i] = true;
+				// read what was written before the worker exited
+				parentRing(i)->read(stream);
+				if(stream.empty() || stream.size() != stream[0] + 1) {
+					std::cerr << "Shard " << i << " died before sending its topology." << std::endl;
+					return false;
+				}
+				complete++;
+			}
+		}
+		sched_yield();
+	}
+
+	adjacency.assign(numberOfNodes, std::vector<uint32_t>());
+	online.assign(numberOfNodes, false);
+	for(std::vector<uint32_t>& stream : streams) {
+		unsigned long pos = 1;
+		while(pos < stream.size()) {
+			uint32_t index = stream[pos++];
+			uint32_t size = stream[pos++];
+			online[index] = true;
+			adjacency[index].assign(stream.begin() + pos, stream.begin() + pos + size);
+			pos += size;
+		}
+	}
+
+	for(unsigned int i = 0; i < numberOfShards; ++i) {
+		if(!exited[i]) {
+			waitpid(workers[i], nullptr, 0);
+		}
+	}
+	return true;
+}
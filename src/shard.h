@@ -0,0 +1,166 @@
+/*!
+ * \brief The shared-memory transport between the worker processes of a sharded simulation
+ */
+
+#ifndef SHARD_H
+#define SHARD_H
+
+#include "node.h"
+#include "message.h"
+#include "constants.h"
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include <memory>
+#include <pthread.h>
+#include <sys/types.h>
+
+/*!
+ * \brief A single-producer/single-consumer ring buffer of 32 bit words.
+ *
+ * The ring lives in shared memory, so it is initialized with init() instead of a constructor.
+ */
+class ShardRing
+{
+public:
+	/*!
+	 * \brief empties the ring
+	 */
+	void init();
+
+	/*!
+	 * \brief writes as many words as fit into the ring
+	 * \param words is the data to write.
+	 * \param count is the number of words to write.
+	 * \return the number of words written
+	 */
+	unsigned long write(const uint32_t* words, unsigned long count);
+
+	/*!
+	 * \brief reads all words which are available
+	 * \param out is the vector the words are appended to.
+	 */
+	void read(std::vector<uint32_t>& out);
+
+private:
+	std::atomic<unsigned long> head; //!< read position, only advanced by the consumer
+	std::atomic<unsigned long> tail; //!< write position, only advanced by the producer
+	uint32_t words[SHARDRINGSIZE]; //!< the buffer
+};
+
+/*!
+ * \brief Connects the worker processes of a sharded simulation.
+ *
+ * Every worker owns the Nodes whose index maps to its shard and mirrors all other Nodes.
+ * Traffic to mirrored Nodes is batched per destination shard and exchanged through
+ * shared-memory rings at the end of every time window, so it arrives with the next window.
+ */
+class ShardContext
+{
+public:
+	typedef std::shared_ptr<ShardContext> ptr; //!< a shared_ptr of type ShardContext.
+
+	/*!
+	 * \brief maps the shared memory of the rings, has to be called before forking the workers
+	 * \param numberOfShards is the number of worker processes.
+	 * \param window is the length of a time window in ticks.
+	 */
+	ShardContext(unsigned int numberOfShards, unsigned long window);
+	~ShardContext();
+
+	/*!
+	 * \brief binds this context to a shard, called by the worker after forking
+	 * \param shardIndex is the shard the worker owns
+	 */
+	void attach(unsigned int shardIndex);
+
+	/*!
+	 * \brief returns the length of a time window in ticks
+	 */
+	unsigned long getWindow();
+
+	/*!
+	 * \brief returns if the Node is simulated by this worker
+	 */
+	bool isLocal(const Node::ptr& node);
+
+	/*!
+	 * \brief sends a connection request to a Node of another shard
+	 * \return true if the request was sent, the connection may still be rejected later
+	 */
+	bool connect(const Node::ptr& originNode, const Node::ptr& destNode);
+
+	/*!
+	 * \brief tells a Node of another shard that originNode closed their connection
+	 */
+	void disconnect(const Node::ptr& originNode, const Node::ptr& destNode);
+
+	/*!
+	 * \brief sends a protocol message to a Node of another shard
+	 * \param type is the type of the message.
+	 * \param sender is the Node the message is sent from.
+	 * \param receiver is the Node the message will be delivered to.
+	 * \param addr is the payload of an "addr" message, the caller keeps its ownership.
+	 */
+	void post(Message::Type type, const Node::ptr& sender, const Node::ptr& receiver, Node::vector* addr);
+
+	/*!
+	 * \brief tells all other shards that a local Node went on- or offline
+	 */
+	void broadcastState(const Node::ptr& node, bool online);
+
+	/*!
+	 * \brief exchanges the batches of this window with all other shards and applies the received ones
+	 * \param simCTX is the simulation of this worker.
+	 */
+	void exchange(Simulation* simCTX);
+
+	/*!
+	 * \brief sends the connections of the local Nodes to the parent process
+	 * \param nodes are the online Nodes of this worker.
+	 */
+	void sendTopology(Node::vector& nodes);
+
+	/*!
+	 * \brief collects the connections of all workers in the parent process
+	 * \param workers are the pids of the worker processes.
+	 * \param numberOfNodes is the size of the whole population.
+	 * \param adjacency will hold the connections of every online Node by index.
+	 * \param online will hold the online state of every Node by index.
+	 * \return false if a worker died before sending its topology
+	 */
+	bool collectTopology(std::vector<pid_t>& workers, unsigned long numberOfNodes, std::vector<std::vector<uint32_t>>& adjacency, std::vector<bool>& online);
+
+private:
+	/*!
+	 * \brief the types of the records exchanged between shards
+	 */
+	enum RecordType : uint32_t {
+		CONNECT,
+		REJECT,
+		DISCONNECT,
+		VERSION,
+		GETADDR,
+		ADDR,
+		ONLINE,
+		OFFLINE
+	};
+
+	ShardRing* ring(unsigned int from, unsigned int to); //!< the ring from one shard to another
+	ShardRing* parentRing(unsigned int from); //!< the ring from a shard to the parent process
+	void apply(Simulation* simCTX, std::vector<uint32_t>& records); //!< applies the records received from one shard
+	unsigned int shardOf(const Node::ptr& node); //!< the shard which simulates a Node
+
+	unsigned int numberOfShards; //!< number of worker processes
+	unsigned int shardIndex; //!< the shard this worker owns
+	unsigned long window; //!< length of a time window in ticks
+	void* memory; //!< the mapped shared memory
+	unsigned long memorySize; //!< the size of the mapped shared memory
+	pthread_barrier_t* barrier; //!< synchronizes the workers at the end of every window
+	std::atomic<unsigned long>* pending; //!< per shard: are there words left to send?
+	ShardRing* rings; //!< numberOfShards * numberOfShards rings between the shards, then one ring per shard to the parent
+	std::vector<std::vector<uint32_t>> outgoing; //!< the batch for every shard of this window
+	std::vector<std::vector<uint32_t>> incoming; //!< the words received from every shard this window
+};
+
+#endif // SHARD_H
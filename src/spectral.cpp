@@ -0,0 +1,248 @@
+#include "spectral.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <thread>
+
+static const unsigned int LANCZOSMAXITERATIONS = 300; //!< the largest Krylov space, it bounds the memory
+static const unsigned int LANCZOSCHECKINTERVAL = 5; //!< iterations between two convergence checks
+static const double LANCZOSTOLERANCE = 1e-9; //!< the relative change of the eigenvalue which counts as converged
+
+/*!
+ * \brief returns the number of eigenvalues of a symmetric tridiagonal matrix below x (Sturm sequence)
+ */
+static unsigned int eigenvaluesBelow(const std::vector<double>& alpha, const std::vector<double>& beta, double x)
+{
+	unsigned int count = 0;
+	double d = 1;
+	for(unsigned int i = 0; i < alpha.size(); ++i) {
+		d = alpha[i] - x - (i > 0 ? beta[i - 1] * beta[i - 1] / d : 0);
+		if(d == 0) d = -1e-300;
+		if(d < 0) count++;
+	}
+	return count;
+}
+
+/*!
+ * \brief returns the k-th smallest eigenvalue (from 0) of a symmetric tridiagonal matrix by bisection
+ */
+static double tridiagonalEigenvalue(const std::vector<double>& alpha, const std::vector<double>& beta, unsigned int k)
+{
+	// Gershgorin bounds
+	double low = alpha[0], high = alpha[0];
+	for(unsigned int i = 0; i < alpha.size(); ++i) {
+		double radius = (i > 0 ? std::fabs(beta[i - 1]) : 0) + (i + 1 < alpha.size() ? std::fabs(beta[i]) : 0);
+		low = std::min(low, alpha[i] - radius);
+		high = std::max(high, alpha[i] + radius);
+	}
+	for(unsigned int step = 0; step < 200 && high - low > 1e-15 * std::max(1.0, std::fabs(low) + std::fabs(high)); ++step) {
+		double mid = (low + high) / 2;
+		if(eigenvaluesBelow(alpha, beta, mid) > k) {
+			high = mid;
+		} else {
+			low = mid;
+		}
+	}
+	return (low + high) / 2;
+}
+
+SpectralEngine::SpectralEngine(const CSRGraph& g, unsigned int threads) : threads(threads)
+{
+	if(this->threads == 0) {
+		this->threads = std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	// label the components, the largest one is analysed
+	uint32_t n = g.numVertices();
+	std::vector<uint32_t> component(n, UINT32_MAX), queue;
+	uint32_t largest = 0, largestSize = 0, components = 0;
+	for(uint32_t s = 0; s < n; ++s) {
+		if(component[s] != UINT32_MAX) continue;
+		queue.assign(1, s);
+		component[s] = components;
+		for(uint32_t head = 0; head < queue.size(); ++head) {
+			for(const uint32_t* u = g.neighborsBegin(queue[head]); u != g.neighborsEnd(queue[head]); ++u) {
+				if(component[*u] == UINT32_MAX) {
+					component[*u] = components;
+					queue.push_back(*u);
+				}
+			}
+		}
+		if(queue.size() > largestSize) {
+			largestSize = queue.size();
+			largest = components;
+		}
+		components++;
+	}
+
+	// renumber the largest component
+	std::vector<uint32_t> local(n, UINT32_MAX);
+	uint32_t vertices = 0;
+	for(uint32_t v = 0; v < n; ++v) {
+		if(component[v] == largest) local[v] = vertices++;
+	}
+	offsets.assign(1, 0);
+	for(uint32_t v = 0; v < n; ++v) {
+		if(local[v] == UINT32_MAX) continue;
+		for(const uint32_t* u = g.neighborsBegin(v); u != g.neighborsEnd(v); ++u) {
+			targets.push_back(local[*u]);
+		}
+		offsets.push_back(targets.size());
+		inverseSqrtDegree.push_back(1 / std::sqrt((double) g.degree(v)));
+	}
+}
+
+template<typename Job>
+void SpectralEngine::forRows(Job job)
+{
+	uint32_t n = offsets.size() - 1;
+	unsigned int count = std::max(1u, std::min<unsigned int>(threads, n / 4096));
+	std::vector<std::thread> workers;
+	for(unsigned int id = 1; id < count; ++id) {
+		workers.emplace_back(job, id, (uint64_t) n * id / count, (uint64_t) n * (id + 1) / count);
+	}
+	job(0, 0, n / count);
+	for(std::thread& t : workers) {
+		t.join();
+	}
+}
+
+void SpectralEngine::multiply(Operator op, const std::vector<double>& x, std::vector<double>& y)
+{
+	forRows([&](unsigned int, uint32_t begin, uint32_t end) {
+		for(uint32_t v = begin; v < end; ++v) {
+			double sum = 0;
+			for(uint64_t e = offsets[v]; e < offsets[v + 1]; ++e) {
+				sum += op == LAPLACIAN ? x[targets[e]] : x[targets[e]] * inverseSqrtDegree[targets[e]];
+			}
+			if(op == LAPLACIAN) {
+				y[v] = (offsets[v + 1] - offsets[v]) * x[v] - sum;
+			} else {
+				y[v] = sum * inverseSqrtDegree[v];
+			}
+		}
+	});
+}
+
+double SpectralEngine::extremeEigenvalue(Operator op, const std::vector<double>& known, bool smallest, unsigned int& iterations, bool& converged)
+{
+	uint32_t n = offsets.size() - 1;
+	std::vector<std::vector<double>> basis;
+	std::vector<double> alpha, beta, w(n), dots;
+
+	// a fixed random start, orthogonal to the known eigenvector
+	std::mt19937 rng(0);
+	std::uniform_real_distribution<double> coordinate(-1, 1);
+	std::vector<double> q(n);
+	for(double& value : q) {
+		value = coordinate(rng);
+	}
+
+	double previous = 0, value = 0;
+	converged = false;
+	for(iterations = 0; iterations < LANCZOSMAXITERATIONS && iterations < n - 1; ++iterations) {
+		// orthogonalize against the known eigenvector and all Lanczos vectors, twice is enough
+		for(unsigned int pass = 0; pass < 2; ++pass) {
+			dots.assign(threads * (basis.size() + 1), 0);
+			forRows([&](unsigned int id, uint32_t begin, uint32_t end) {
+				double* partial = dots.data() + id * (basis.size() + 1);
+				for(uint32_t v = begin; v < end; ++v) {
+					partial[0] += known[v] * q[v];
+				}
+				for(unsigned int j = 0; j < basis.size(); ++j) {
+					const std::vector<double>& b = basis[j];
+					double sum = 0;
+					for(uint32_t v = begin; v < end; ++v) {
+						sum += b[v] * q[v];
+					}
+					partial[j + 1] = sum;
+				}
+			});
+			for(unsigned int id = 1; id < threads; ++id) {
+				for(unsigned int j = 0; j <= basis.size(); ++j) {
+					dots[j] += dots[id * (basis.size() + 1) + j];
+				}
+			}
+			forRows([&](unsigned int, uint32_t begin, uint32_t end) {
+				for(uint32_t v = begin; v < end; ++v) {
+					double projected = q[v] - dots[0] * known[v];
+					for(unsigned int j = 0; j < basis.size(); ++j) {
+						projected -= dots[j + 1] * basis[j][v];
+					}
+					q[v] = projected;
+				}
+			});
+		}
+
+		double norm = 0;
+		for(double value : q) {
+			norm += value * value;
+		}
+		norm = std::sqrt(norm);
+		if(iterations > 0) {
+			// the Krylov space is invariant, the Ritz values are exact
+			if(norm < 1e-10) {
+				converged = true;
+				break;
+			}
+			beta.push_back(norm);
+		}
+		for(double& value : q) {
+			value /= norm;
+		}
+		basis.push_back(q);
+
+		multiply(op, q, w);
+		double a = 0;
+		for(uint32_t v = 0; v < n; ++v) {
+			a += q[v] * w[v];
+		}
+		alpha.push_back(a);
+
+		// the next vector, the three-term recurrence is completed by the reorthogonalization
+		q.swap(w);
+
+		if(alpha.size() % LANCZOSCHECKINTERVAL == 0) {
+			value = tridiagonalEigenvalue(alpha, std::vector<double>(beta.begin(), beta.begin() + alpha.size() - 1), smallest ? 0 : alpha.size() - 1);
+			if(alpha.size() > LANCZOSCHECKINTERVAL && std::fabs(value - previous) <= LANCZOSTOLERANCE * std::max(1.0, std::fabs(value))) {
+				converged = true;
+				return value;
+			}
+			previous = value;
+		}
+	}
+	if(alpha.empty()) return 0;
+	if(iterations >= n - 1) converged = true;
+	return tridiagonalEigenvalue(alpha, std::vector<double>(beta.begin(), beta.begin() + alpha.size() - 1), smallest ? 0 : alpha.size() - 1);
+}
+
+SpectralStats SpectralEngine::calculate()
+{
+	SpectralStats stats;
+	uint32_t n = offsets.size() - 1;
+	stats.vertices = n;
+	if(n < 3) return stats;
+
+	// the constant vector spans the kernel of the Laplacian
+	std::vector<double> constant(n, 1 / std::sqrt((double) n));
+	unsigned int iterations;
+	bool converged;
+	stats.algebraicConnectivity = extremeEigenvalue(LAPLACIAN, constant, true, iterations, converged);
+	stats.iterations = iterations;
+	stats.converged = converged;
+
+	// sqrt(degree) is the eigenvector of the largest eigenvalue, 1, of the normalized adjacency
+	std::vector<double> stationary(n);
+	double norm = 0;
+	for(uint32_t v = 0; v < n; ++v) {
+		stationary[v] = 1 / inverseSqrtDegree[v];
+		norm += stationary[v] * stationary[v];
+	}
+	for(double& value : stationary) {
+		value /= std::sqrt(norm);
+	}
+	stats.spectralGap = 1 - extremeEigenvalue(NORMALIZEDADJACENCY, stationary, false, iterations, converged);
+	stats.iterations += iterations;
+	stats.converged = stats.converged && converged;
+	return stats;
+}
@@ -0,0 +1,80 @@
+/*!
+ * \brief The spectrum of a graph, how well it mixes
+ */
+
+#ifndef SPECTRAL_H
+#define SPECTRAL_H
+
+#include "csrgraph.h"
+#include <cstdint>
+#include <vector>
+
+/*!
+ * \brief The extremal eigenvalues of the largest connected component of a graph.
+ */
+typedef struct SpectralStats {
+	uint32_t vertices = 0; //!< the number of vertices of the largest component
+	double algebraicConnectivity = 0; //!< the second smallest eigenvalue of the Laplacian D - A
+	double spectralGap = 0; //!< 1 - the second largest eigenvalue of the random walk D^-1 A
+	unsigned int iterations = 0; //!< the Lanczos iterations of both eigenvalues
+	bool converged = true; //!< did both eigenvalues converge within LANCZOSMAXITERATIONS?
+} SpectralStats;
+
+/*!
+ * \brief Calculates the algebraic connectivity and the spectral gap with the Lanczos method.
+ *
+ * Both eigenvalues are extremal once the known eigenvector of the operator is projected out:
+ * the constant vector of the Laplacian and sqrt(degree) of the normalized adjacency
+ * D^-1/2 A D^-1/2, which has the eigenvalues of the random walk. The Lanczos vectors are
+ * fully reorthogonalized, so memory is LANCZOSMAXITERATIONS vectors of the component size.
+ * The matrix-vector products and the reorthogonalization are split over the threads by rows.
+ */
+class SpectralEngine
+{
+public:
+	/*!
+	 * \param g is the graph, only its largest connected component is analysed.
+	 * \param threads is the number of threads, 0 uses one per hardware thread.
+	 */
+	SpectralEngine(const CSRGraph& g, unsigned int threads);
+
+	/*!
+	 * \brief calculates the algebraic connectivity and the spectral gap
+	 */
+	SpectralStats calculate();
+
+private:
+	/*!
+	 * \brief the operators whose spectrum is calculated
+	 */
+	enum Operator {
+		LAPLACIAN, //!< D - A
+		NORMALIZEDADJACENCY //!< D^-1/2 A D^-1/2
+	};
+
+	/*!
+	 * \brief runs the Lanczos iteration on the orthogonal complement of a known eigenvector
+	 * \param op is the operator.
+	 * \param known is the known (normalized) eigenvector.
+	 * \param smallest selects the smallest instead of the largest remaining eigenvalue.
+	 * \param iterations will hold the number of iterations.
+	 * \param converged will be false if the eigenvalue didn't converge.
+	 */
+	double extremeEigenvalue(Operator op, const std::vector<double>& known, bool smallest, unsigned int& iterations, bool& converged);
+
+	void multiply(Operator op, const std::vector<double>& x, std::vector<double>& y); //!< y = op * x
+
+	/*!
+	 * \brief runs a function on disjoint row ranges in parallel
+	 * \param job is called with the thread id and its range of rows.
+	 */
+	template<typename Job>
+	void forRows(Job job);
+
+	unsigned int threads; //!< the number of threads
+	std::vector<uint64_t> offsets; //!< the CSR offsets of the largest component, renumbered
+	std::vector<uint32_t> targets; //!< the CSR targets of the largest component, renumbered
+	std::vector<double> inverseSqrtDegree; //!< 1 / sqrt(degree) of every vertex of the component
+};
+
+#endif // SPECTRAL_H
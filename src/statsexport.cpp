@@ -0,0 +1,109 @@
+#include "statsexport.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+bool readStatsBlock(const StatsBlock* block, StatsBlock& copy)
+{
+	for(unsigned int attempt = 0; attempt < 1000; ++attempt) {
+		uint64_t before = block->sequence.load(std::memory_order_acquire);
+		if(before & 1) continue;
+		std::memcpy(static_cast<void*>(&copy), static_cast<const void*>(block), sizeof(StatsBlock));
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if(block->sequence.load(std::memory_order_relaxed) == before) return true;
+	}
+	return false;
+}
+
+StatsExport::StatsExport(std::string name, uint32_t shard, uint32_t shards) : block(nullptr), lastClock(0), lastTime(std::chrono::steady_clock::now()), startTime(lastTime)
+{
+	if(name.empty() || name[0] != '/') name = "/" + name;
+	// a segment of an earlier run may still be mapped by a reader, so it is replaced instead of truncated
+	shm_unlink(name.c_str());
+	int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+	if(fd < 0) {
+		perror("shm_open");
+		statm = -1;
+		return;
+	}
+	if(ftruncate(fd, sizeof(StatsBlock)) == 0) {
+		void* memory = mmap(nullptr, sizeof(StatsBlock), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		if(memory != MAP_FAILED) {
+			// the new segment is zeroed, so readers see no magic until the header is complete
+			block = static_cast<StatsBlock*>(memory);
+			block->pid = getpid();
+			block->shard = shard;
+			block->shards = shards;
+			block->version = STATSVERSION;
+			std::atomic_thread_fence(std::memory_order_release);
+			block->magic = STATSMAGIC;
+		} else {
+			perror("mmap");
+		}
+	}
+	close(fd);
+
+	statm = open("/proc/self/statm", O_RDONLY);
+}
+
+StatsExport::~StatsExport()
+{
+	if(block != nullptr) {
+		munmap(block, sizeof(StatsBlock));
+	}
+	if(statm >= 0) {
+		close(statm);
+	}
+}
+
+bool StatsExport::isOpen() const
+{
+	return block != nullptr;
+}
+
+uint64_t StatsExport::residentBytes()
+{
+	char buffer[128];
+	if(statm < 0) return 0;
+	ssize_t length = pread(statm, buffer, sizeof(buffer) - 1, 0);
+	if(length <= 0) return 0;
+	buffer[length] = '\0';
+
+	// the second field are the resident pages
+	unsigned long long size, resident;
+	if(sscanf(buffer, "%llu %llu", &size, &resident) != 2) return 0;
+	return resident * sysconf(_SC_PAGESIZE);
+}
+
+void StatsExport::publish(const StatsBlock& values)
+{
+	if(block == nullptr) return;
+
+	// the last update may come right after the previous one, so the final rate is the one of the whole run
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	double seconds = std::chrono::duration<double>(now - (values.finished ? startTime : lastTime)).count();
+	double ticksPerSecond = seconds > 0 ? (values.simClock - (values.finished ? 0 : lastClock)) / seconds : 0;
+	lastTime = now;
+	lastClock = values.simClock;
+	uint64_t resident = residentBytes();
+
+	uint64_t sequence = block->sequence.load(std::memory_order_relaxed);
+	block->sequence.store(sequence + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	block->simClock = values.simClock;
+	block->endTime = values.endTime;
+	block->ticksPerSecond = ticksPerSecond;
+	block->onlineNodes = values.onlineNodes;
+	block->offlineNodes = values.offlineNodes;
+	block->connectionEnds = values.connectionEnds;
+	block->versionMessages = values.versionMessages;
+	block->getaddrMessages = values.getaddrMessages;
+	block->addrMessages = values.addrMessages;
+	block->addrEntries = values.addrEntries;
+	block->residentBytes = resident;
+	block->finished = values.finished;
+	block->sequence.store(sequence + 2, std::memory_order_release);
+}
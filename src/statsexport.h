@@ -0,0 +1,91 @@
+/*!
+ * \brief The live statistics of a running simulation in POSIX shared memory
+ */
+
+#ifndef STATSEXPORT_H
+#define STATSEXPORT_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+static const uint32_t STATSMAGIC = 0x53545442; //!< "BTTS" in little endian, the start of every block
+static const uint32_t STATSVERSION = 1; //!< the layout of StatsBlock, readers reject other versions
+
+/*!
+ * \brief The values of the shared-memory segment, shared by the simulation and bittopsimstat.
+ *
+ * The block is a seqlock: the writer makes sequence odd, writes the values and makes it even
+ * again. A reader copies the block and retries if sequence was odd or changed meanwhile, so
+ * neither side ever waits for the other.
+ */
+typedef struct StatsBlock {
+	uint32_t magic; //!< STATSMAGIC once the block is initialized
+	uint32_t version; //!< STATSVERSION
+	std::atomic<uint64_t> sequence; //!< odd while the writer updates the values
+	uint64_t pid; //!< the process which writes the block
+	uint32_t shard; //!< the worker of a sharded simulation, 0 without --shards
+	uint32_t shards; //!< the number of workers, 1 without --shards
+	uint64_t simClock; //!< the current tick
+	uint64_t endTime; //!< the tick the run ends at
+	double ticksPerSecond; //!< simulated ticks per wall clock second since the previous update, since the start once finished
+	uint64_t onlineNodes; //!< the online nodes of the population
+	uint64_t offlineNodes; //!< the offline nodes of the population
+	uint64_t connectionEnds; //!< the open connections of the simulated nodes, counted at both ends
+	uint64_t versionMessages; //!< the "version" messages sent so far
+	uint64_t getaddrMessages; //!< the "getaddr" messages sent so far
+	uint64_t addrMessages; //!< the "addr" messages sent so far
+	uint64_t addrEntries; //!< the addresses carried by all "addr" messages so far
+	uint64_t residentBytes; //!< the resident set size of the process, 0 if unknown
+	uint32_t finished; //!< 1 once the run is over and the values are final
+} StatsBlock;
+
+/*!
+ * \brief reads a consistent copy of a block
+ * \param block is the block in shared memory.
+ * \param copy will hold the values.
+ * \return false if the writer was updating the block during all retries
+ */
+bool readStatsBlock(const StatsBlock* block, StatsBlock& copy);
+
+/*!
+ * \brief Publishes a StatsBlock in a POSIX shared-memory segment.
+ *
+ * The segment is created anew at the start, readers of an older run keep their stale copy.
+ * It is left with the final values after the run, so it can be read until it is removed
+ * from /dev/shm.
+ */
+class StatsExport
+{
+public:
+	typedef std::shared_ptr<StatsExport> ptr; //!< a shared_ptr of type StatsExport.
+
+	/*!
+	 * \param name is the name of the segment, a leading '/' is added if it is missing.
+	 * \param shard is the worker writing the block.
+	 * \param shards is the number of workers.
+	 */
+	StatsExport(std::string name, uint32_t shard, uint32_t shards);
+	~StatsExport();
+
+	bool isOpen() const; //!< returns if the segment could be created
+
+	/*!
+	 * \brief writes new values, the rate and the process values are filled in
+	 * \param values are the simulation values of the block, its header is ignored.
+	 */
+	void publish(const StatsBlock& values);
+
+private:
+	uint64_t residentBytes(); //!< returns the resident set size of the process
+
+	StatsBlock* block; //!< the mapped block, nullptr if the segment couldn't be created
+	int statm; //!< /proc/self/statm, -1 if it isn't available
+	uint64_t lastClock; //!< the tick of the previous update
+	std::chrono::steady_clock::time_point lastTime; //!< the wall clock time of the previous update
+	std::chrono::steady_clock::time_point startTime; //!< the wall clock time the segment was created, at tick 0
+};
+
+#endif // STATSEXPORT_H
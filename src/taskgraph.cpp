@@ -0,0 +1,87 @@
+#include "taskgraph.h"
+#include <algorithm>
+#include <thread>
+
+TaskGraph::TaskGraph(unsigned int threads) : threads(threads), unfinished(0)
+{
+	if(this->threads == 0) {
+		this->threads = std::max(1u, std::thread::hardware_concurrency());
+	}
+}
+
+unsigned int TaskGraph::getThreads() const
+{
+	return threads;
+}
+
+TaskGraph::Task TaskGraph::add(std::function<void()> work, const std::vector<Task>& dependencies)
+{
+	Task task = this->work.size();
+	this->work.push_back(std::move(work));
+	dependents.emplace_back();
+	pending.push_back(dependencies.size());
+	for(Task dependency : dependencies) {
+		dependents[dependency].push_back(task);
+	}
+	if(dependencies.empty()) {
+		ready.push_back(task);
+	}
+	return task;
+}
+
+void TaskGraph::worker()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	while(true) {
+		changed.wait(lock, [this]() { return unfinished == 0 || !ready.empty(); });
+		if(unfinished == 0) return;
+
+		Task task = ready.front();
+		ready.pop_front();
+		if(failure == nullptr) {
+			lock.unlock();
+			std::exception_ptr thrown;
+			try {
+				work[task]();
+			} catch(...) {
+				thrown = std::current_exception();
+			}
+			// the work can hold large captures, it is released outside the lock
+			work[task] = nullptr;
+			lock.lock();
+			if(thrown != nullptr && failure == nullptr) {
+				failure = thrown;
+			}
+		}
+
+		// a failed run skips the rest, its dependents are still released so every task is accounted for
+		for(Task dependent : dependents[task]) {
+			if(--pending[dependent] == 0) {
+				ready.push_back(dependent);
+			}
+		}
+		--unfinished;
+		changed.notify_all();
+	}
+}
+
+void TaskGraph::run()
+{
+	unfinished = work.size();
+	failure = nullptr;
+
+	// no more threads than tasks, the graph never has more of them ready
+	unsigned int count = std::min<unsigned int>(threads, work.size());
+	std::vector<std::thread> workers;
+	for(unsigned int id = 1; id < count; ++id) {
+		workers.emplace_back(&TaskGraph::worker, this);
+	}
+	worker();
+	for(std::thread& t : workers) {
+		t.join();
+	}
+
+	if(failure != nullptr) {
+		std::rethrow_exception(failure);
+	}
+}
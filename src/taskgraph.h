@@ -0,0 +1,63 @@
+/*!
+ * \brief Runs tasks with dependencies concurrently on a pool of threads
+ */
+
+#ifndef TASKGRAPH_H
+#define TASKGRAPH_H
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+/*!
+ * \brief A graph of tasks which is executed on a pool of threads.
+ *
+ * A task becomes ready once all the tasks it depends on are done, the ready tasks are
+ * taken in the order they were added. The graph is built first and then run once.
+ */
+class TaskGraph
+{
+public:
+	typedef unsigned int Task; //!< the handle of a task, valid within its graph
+
+	/*!
+	 * \param threads is the number of threads to use, 0 uses one per hardware thread.
+	 */
+	TaskGraph(unsigned int threads = 0);
+
+	/*!
+	 * \brief adds a task to the graph
+	 * \param work is the work of the task.
+	 * \param dependencies are the tasks which have to be done before it starts.
+	 * \return the handle of the task
+	 */
+	Task add(std::function<void()> work, const std::vector<Task>& dependencies = {});
+
+	/*!
+	 * \brief runs all tasks and returns once they are done
+	 *
+	 * If a task throws, the tasks which are running are finished, the ones which aren't started
+	 * are skipped and the first exception is rethrown.
+	 */
+	void run();
+
+	unsigned int getThreads() const; //!< returns the number of threads the graph runs on
+
+private:
+	void worker(); //!< runs ready tasks until all tasks are done
+
+	unsigned int threads; //!< the number of threads, thread 0 is the calling one
+	std::vector<std::function<void()>> work; //!< the work of every task
+	std::vector<std::vector<Task>> dependents; //!< the tasks waiting for every task
+	std::vector<unsigned int> pending; //!< the number of unfinished dependencies of every task
+	std::deque<Task> ready; //!< the tasks which can start
+	unsigned int unfinished; //!< the tasks which aren't done yet
+	std::exception_ptr failure; //!< the first exception a task threw
+	std::mutex mutex; //!< guards the scheduling state
+	std::condition_variable changed; //!< signals new ready tasks and the end of the run
+};
+
+#endif // TASKGRAPH_H
@@ -0,0 +1,288 @@
+#include "topologylog.h"
+#include <algorithm>
+#include <unordered_set>
+
+static const char TOPOLOGYLOGMAGIC[4] = {'B', 'T', 'T', 'L'};
+static const uint8_t TOPOLOGYLOGVERSION = 1;
+static const unsigned long MAXDELTABLOCKSIZE = 1 << 16;
+
+static void putVarint(std::vector<uint8_t>& out, uint64_t value)
+{
+	while(value >= 0x80) {
+		out.push_back((value & 0x7f) | 0x80);
+		value >>= 7;
+	}
+	out.push_back(value);
+}
+
+static bool getVarint(std::istream& in, uint64_t& value)
+{
+	value = 0;
+	for(unsigned int shift = 0; shift < 64; shift += 7) {
+		int byte = in.get();
+		if(byte == EOF) return false;
+		value |= (uint64_t) (byte & 0x7f) << shift;
+		if(!(byte & 0x80)) return true;
+	}
+	return false;
+}
+
+static bool getVarint(const uint8_t*& pos, const uint8_t* end, uint64_t& value)
+{
+	value = 0;
+	for(unsigned int shift = 0; shift < 64 && pos < end; shift += 7) {
+		uint8_t byte = *pos++;
+		value |= (uint64_t) (byte & 0x7f) << shift;
+		if(!(byte & 0x80)) return true;
+	}
+	return false;
+}
+
+static uint64_t edgeKey(uint32_t a, uint32_t b)
+{
+	return a < b ? ((uint64_t) a << 32) | b : ((uint64_t) b << 32) | a;
+}
+
+TopologyLog::TopologyLog(std::string path, uint32_t numberOfNodes, unsigned long keyframeInterval) : file(path, std::ios::binary), keyframeInterval(keyframeInterval), nextKeyframe(0), deltaEvents(0), deltaStart(0), lastEvent(0)
+{
+	if(!file.is_open()) return;
+
+	std::vector<uint8_t> header(TOPOLOGYLOGMAGIC, TOPOLOGYLOGMAGIC + 4);
+	header.push_back(TOPOLOGYLOGVERSION);
+	putVarint(header, numberOfNodes);
+	putVarint(header, keyframeInterval);
+	file.write(reinterpret_cast<const char*>(header.data()), header.size());
+
+	// the empty topology before the first event
+	writeKeyframe(0);
+}
+
+TopologyLog::~TopologyLog()
+{
+	close();
+}
+
+bool TopologyLog::isOpen()
+{
+	return file.is_open();
+}
+
+void TopologyLog::connectionOpened(unsigned long time, uint32_t a, uint32_t b)
+{
+	// an edge exists while at least one of its Nodes holds a connection to the other
+	if(references[edgeKey(a, b)]++ == 0) {
+		record(time, false, a, b);
+	}
+}
+
+void TopologyLog::connectionClosed(unsigned long time, uint32_t a, uint32_t b)
+{
+	auto it = references.find(edgeKey(a, b));
+	if(it == std::end(references)) return;
+
+	if(--it->second == 0) {
+		references.erase(it);
+		record(time, true, a, b);
+	}
+}
+
+void TopologyLog::record(unsigned long time, bool removed, uint32_t a, uint32_t b)
+{
+	if(!file.is_open()) return;
+
+	if(time >= nextKeyframe) {
+		writeDeltaBlock();
+		writeKeyframe(time);
+	}
+
+	if(deltaEvents == 0) {
+		deltaStart = time;
+		lastEvent = time;
+	}
+	putVarint(deltas, (time - lastEvent) << 1 | (removed ? 1 : 0));
+	putVarint(deltas, std::min(a, b));
+	putVarint(deltas, std::max(a, b));
+	deltaEvents++;
+	lastEvent = time;
+
+	if(deltas.size() >= MAXDELTABLOCKSIZE) {
+		writeDeltaBlock();
+	}
+}
+
+void TopologyLog::writeDeltaBlock()
+{
+	if(deltaEvents == 0) return;
+
+	std::vector<uint8_t> header;
+	header.push_back('D');
+	putVarint(header, deltaStart);
+	putVarint(header, deltaEvents);
+	putVarint(header, deltas.size());
+	file.write(reinterpret_cast<const char*>(header.data()), header.size());
+	file.write(reinterpret_cast<const char*>(deltas.data()), deltas.size());
+
+	deltas.clear();
+	deltaEvents = 0;
+}
+
+void TopologyLog::writeKeyframe(unsigned long time)
+{
+	std::vector<uint64_t> edges;
+	edges.reserve(references.size());
+	for(auto& edge : references) {
+		edges.push_back(edge.first);
+	}
+	std::sort(std::begin(edges), std::end(edges));
+
+	std::vector<uint8_t> block;
+	block.push_back('K');
+	putVarint(block, time);
+	putVarint(block, edges.size());
+	uint32_t previousA = 0, previousB = 0;
+	for(uint64_t edge : edges) {
+		uint32_t a = edge >> 32, b = edge & 0xffffffff;
+		putVarint(block, a - previousA);
+		putVarint(block, b - (a != previousA ? a : previousB));
+		previousA = a;
+		previousB = b;
+	}
+
+	index.push_back(std::make_pair(time, (unsigned long) file.tellp()));
+	file.write(reinterpret_cast<const char*>(block.data()), block.size());
+	nextKeyframe = time + keyframeInterval;
+}
+
+void TopologyLog::close()
+{
+	if(!file.is_open()) return;
+
+	writeDeltaBlock();
+
+	uint64_t indexOffset = file.tellp();
+	std::vector<uint8_t> block;
+	block.push_back('I');
+	putVarint(block, index.size());
+	unsigned long previousTime = 0, previousOffset = 0;
+	for(auto& keyframe : index) {
+		putVarint(block, keyframe.first - previousTime);
+		putVarint(block, keyframe.second - previousOffset);
+		previousTime = keyframe.first;
+		previousOffset = keyframe.second;
+	}
+	for(unsigned int i = 0; i < 8; ++i) {
+		block.push_back(indexOffset >> (8 * i));
+	}
+	block.insert(std::end(block), TOPOLOGYLOGMAGIC, TOPOLOGYLOGMAGIC + 4);
+	file.write(reinterpret_cast<const char*>(block.data()), block.size());
+	file.close();
+}
+
+TopologyLogReader::TopologyLogReader(std::string path) : file(path, std::ios::binary), valid(false), numberOfNodes(0)
+{
+	if(!file.is_open()) return;
+
+	char magic[4];
+	uint64_t value;
+	if(!file.read(magic, 4) || !std::equal(magic, magic + 4, TOPOLOGYLOGMAGIC)) return;
+	if(file.get() != TOPOLOGYLOGVERSION) return;
+	if(!getVarint(file, value)) return;
+	numberOfNodes = value;
+	if(!getVarint(file, value)) return;
+
+	// the footer points to the index
+	uint8_t footer[12];
+	file.seekg(-12, std::ios::end);
+	if(!file.read(reinterpret_cast<char*>(footer), 12) || !std::equal(footer + 8, footer + 12, TOPOLOGYLOGMAGIC)) return;
+	uint64_t indexOffset = 0;
+	for(unsigned int i = 0; i < 8; ++i) {
+		indexOffset |= (uint64_t) footer[i] << (8 * i);
+	}
+
+	file.seekg(indexOffset);
+	uint64_t count, time = 0, offset = 0, delta;
+	if(file.get() != 'I' || !getVarint(file, count)) return;
+	for(uint64_t i = 0; i < count; ++i) {
+		if(!getVarint(file, delta)) return;
+		time += delta;
+		if(!getVarint(file, delta)) return;
+		offset += delta;
+		index.push_back(std::make_pair(time, offset));
+	}
+	valid = !index.empty();
+}
+
+bool TopologyLogReader::isOpen()
+{
+	return valid;
+}
+
+uint32_t TopologyLogReader::getNumberOfNodes()
+{
+	return numberOfNodes;
+}
+
+std::vector<unsigned long> TopologyLogReader::getKeyframeTimes()
+{
+	std::vector<unsigned long> times;
+	for(auto& keyframe : index) {
+		times.push_back(keyframe.first);
+	}
+	return times;
+}
+
+bool TopologyLogReader::topologyAt(unsigned long time, std::vector<std::pair<uint32_t, uint32_t>>& edges)
+{
+	edges.clear();
+	if(!valid) return false;
+
+	// the last keyframe at or before the time, the first one is at 0
+	auto keyframe = std::upper_bound(std::begin(index), std::end(index), std::make_pair(time, ~0UL)) - 1;
+	file.clear();
+	file.seekg(keyframe->second);
+
+	uint64_t value, count, a = 0, b = 0;
+	if(file.get() != 'K' || !getVarint(file, value) || !getVarint(file, count)) return false;
+	std::unordered_set<uint64_t> topology;
+	for(uint64_t i = 0; i < count; ++i) {
+		uint64_t deltaA, deltaB;
+		if(!getVarint(file, deltaA) || !getVarint(file, deltaB)) return false;
+		b = deltaB + (deltaA != 0 ? a + deltaA : b);
+		a += deltaA;
+		topology.insert(edgeKey(a, b));
+	}
+
+	// apply the delta blocks up to the next keyframe
+	std::vector<uint8_t> block;
+	bool done = false;
+	while(!done && file.peek() == 'D') {
+		file.get();
+		uint64_t eventTime, events, size;
+		if(!getVarint(file, eventTime) || !getVarint(file, events) || !getVarint(file, size)) return false;
+		if(eventTime > time) break;
+
+		block.resize(size);
+		if(!file.read(reinterpret_cast<char*>(block.data()), size)) return false;
+		const uint8_t* pos = block.data();
+		const uint8_t* end = pos + size;
+		for(uint64_t i = 0; i < events; ++i) {
+			if(!getVarint(pos, end, value) || !getVarint(pos, end, a) || !getVarint(pos, end, b)) return false;
+			eventTime += value >> 1;
+			if(eventTime > time) {
+				done = true;
+				break;
+			}
+			if(value & 1) {
+				topology.erase(edgeKey(a, b));
+			} else {
+				topology.insert(edgeKey(a, b));
+			}
+		}
+	}
+
+	for(uint64_t edge : topology) {
+		edges.push_back(std::make_pair(edge >> 32, edge & 0xffffffff));
+	}
+	std::sort(std::begin(edges), std::end(edges));
+	return true;
+}
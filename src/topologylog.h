@@ -0,0 +1,125 @@
+/*!
+ * \brief A compact log of the changes of the overlay topology
+ */
+
+#ifndef TOPOLOGYLOG_H
+#define TOPOLOGYLOG_H
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/*!
+ * \brief Writes the additions and removals of edges, with periodic keyframes of the whole topology.
+ *
+ * File layout, all numbers are unsigned LEB128 varints unless noted otherwise:
+ * - header: "BTTL", version byte, number of nodes, keyframe interval
+ * - keyframe block: 'K', time, number of edges, the sorted edges (a < b) as (a - previous a, b - (a changed ? a : previous b))
+ * - delta block: 'D', time of the first event, number of events, number of bytes, the events as
+ *   ((time - previous time) << 1 | removed, a, b)
+ * - index: 'I', number of keyframes, (time - previous time, offset - previous offset) per keyframe
+ * - footer: the offset of the index as 8 byte little endian, "BTTL"
+ *
+ * A keyframe at time t holds the topology before the events at time t.
+ */
+class TopologyLog
+{
+public:
+	typedef std::shared_ptr<TopologyLog> ptr; //!< a shared_ptr of type TopologyLog.
+
+	/*!
+	 * \param path is the file the log is written to.
+	 * \param numberOfNodes is the size of the node population.
+	 * \param keyframeInterval is the minimal time between two keyframes in ticks.
+	 */
+	TopologyLog(std::string path, uint32_t numberOfNodes, unsigned long keyframeInterval);
+	~TopologyLog();
+
+	/*!
+	 * \brief returns if the file could be opened
+	 */
+	bool isOpen();
+
+	/*!
+	 * \brief records that a Node opened a connection to another one
+	 * \param time is the current simulation time.
+	 * \param a is the index of the Node which holds the connection.
+	 * \param b is the index of its peer.
+	 */
+	void connectionOpened(unsigned long time, uint32_t a, uint32_t b);
+
+	/*!
+	 * \brief records that a Node closed its connection to another one
+	 * \param time is the current simulation time.
+	 * \param a is the index of the Node which held the connection.
+	 * \param b is the index of its peer.
+	 */
+	void connectionClosed(unsigned long time, uint32_t a, uint32_t b);
+
+	/*!
+	 * \brief writes the pending events and the index, no events can be recorded afterwards
+	 */
+	void close();
+
+private:
+	void record(unsigned long time, bool removed, uint32_t a, uint32_t b); //!< appends an edge event to the delta block
+	void writeDeltaBlock(); //!< writes the pending events
+	void writeKeyframe(unsigned long time); //!< writes the current topology
+
+	std::ofstream file; //!< the log file
+	unsigned long keyframeInterval; //!< the minimal time between two keyframes
+	unsigned long nextKeyframe; //!< the first time the next keyframe may be written
+	std::unordered_map<uint64_t, uint8_t> references; //!< per edge: the number of its Nodes holding a connection to the other
+	std::vector<uint8_t> deltas; //!< the encoded events of the pending delta block
+	unsigned long deltaEvents; //!< the number of pending events
+	unsigned long deltaStart; //!< the time of the first pending event
+	unsigned long lastEvent; //!< the time of the last recorded event
+	std::vector<std::pair<unsigned long, unsigned long>> index; //!< (time, offset) of every keyframe
+};
+
+/*!
+ * \brief Rebuilds the topology at any time from a TopologyLog file.
+ */
+class TopologyLogReader
+{
+public:
+	/*!
+	 * \param path is the log file to read.
+	 */
+	TopologyLogReader(std::string path);
+
+	/*!
+	 * \brief returns if the file is a complete topology log
+	 */
+	bool isOpen();
+
+	/*!
+	 * \brief returns the size of the node population
+	 */
+	uint32_t getNumberOfNodes();
+
+	/*!
+	 * \brief returns the times of all keyframes
+	 */
+	std::vector<unsigned long> getKeyframeTimes();
+
+	/*!
+	 * \brief rebuilds the topology after all events up to a time
+	 * \param time is the simulation time.
+	 * \param edges will hold the edges (a < b), sorted.
+	 * \return false if the log couldn't be read
+	 */
+	bool topologyAt(unsigned long time, std::vector<std::pair<uint32_t, uint32_t>>& edges);
+
+private:
+	std::ifstream file; //!< the log file
+	bool valid; //!< is the file a complete topology log?
+	uint32_t numberOfNodes; //!< the size of the node population
+	std::vector<std::pair<unsigned long, unsigned long>> index; //!< (time, offset) of every keyframe
+};
+
+#endif // TOPOLOGYLOG_H